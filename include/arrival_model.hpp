@@ -0,0 +1,78 @@
+#pragma once
+
+#include "inicpp.h"
+#include "qperf.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qperf {
+    enum class ArrivalProcess : uint8_t
+    {
+        kPeriodic,
+        kPoisson,
+        kOnOff,
+        kSyncBurst
+    };
+
+    /**
+     * @brief Arrival process of the objects of a publish track
+     */
+    struct ArrivalConfig
+    {
+        ArrivalProcess process;
+        std::uint64_t seed;
+        double on_time;              // onoff: mean ms of an on period, publishing every time_interval
+        double off_time;             // onoff: mean ms of an off period
+        std::uint64_t burst_period;  // sync_burst: ms between bursts, aligned to the wall clock epoch
+        std::uint32_t burst_size;    // sync_burst: objects per burst
+        std::uint32_t burst_spacing; // sync_burst: us between the objects of a burst
+    };
+
+    /**
+     * @brief Gaps between object publishes precomputed for the whole test
+     * @details The writer advances its publish deadline by one gap per object. An empty schedule is the
+     *          periodic process, the writer keeps using time_interval.
+     */
+    class ArrivalSchedule
+    {
+      public:
+        ArrivalSchedule() = default;
+
+        static ArrivalSchedule Build(const ArrivalConfig& arrival_config, const PerfConfig& perf_config);
+
+        bool Empty() const noexcept { return gaps_.empty(); }
+        std::size_t Length() const noexcept { return gaps_.size(); }
+
+        /**
+         * @brief Microseconds from the index'th publish to the next, wraps past the end of the schedule
+         */
+        std::uint32_t Gap(std::uint64_t index) const noexcept { return gaps_[index % gaps_.size()]; }
+
+        /**
+         * @brief Microseconds to wait before the first publish so bursts line up across clients
+         */
+        std::uint64_t StartDelay(std::uint64_t epoch_now_us) const noexcept
+        {
+            return align_us_ ? align_us_ - epoch_now_us % align_us_ : 0;
+        }
+
+        /**
+         * @brief Index of the first gap of the next burst, publishing resumes there after a pause
+         */
+        std::uint64_t NextAlignedIndex(std::uint64_t index) const noexcept
+        {
+            return align_objects_ ? (index + align_objects_ - 1) / align_objects_ * align_objects_ : index;
+        }
+
+      private:
+        std::vector<std::uint32_t> gaps_;
+        std::uint64_t align_us_{ 0 };
+        std::uint64_t align_objects_{ 0 };
+    };
+
+    bool PopulateArrivalProcess(const ini::IniSection& section, ArrivalConfig& config);
+
+    std::string ArrivalProcessToString(ArrivalProcess process);
+} // namespace qperf
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <spdlog/sinks/sink.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace qperf {
+    /**
+     * @brief spdlog sink that hands preformatted log lines to a background writer
+     * @details Callers format the line straight into a fixed size slot of a bounded lock-free queue and
+     *          return. A background thread batches the slots to the file. When the queue is full the
+     *          line is dropped and counted instead of blocking the caller, so logging from the transport
+     *          callbacks or the publish loop never waits on stderr.
+     */
+    class AsyncLogSink : public spdlog::sinks::sink
+    {
+      public:
+        static constexpr std::size_t kMaxLineSize = 512;
+
+        AsyncLogSink(std::FILE* file, std::size_t queue_size);
+        ~AsyncLogSink() override;
+
+        void log(const spdlog::details::log_msg& msg) override;
+
+        /**
+         * @brief Wait for the background writer to write out everything queued so far
+         */
+        void flush() override;
+
+        // Lines use a fixed format so they can be written without a per-thread formatter
+        void set_pattern(const std::string&) override {}
+        void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+        std::uint64_t Dropped() const noexcept { return dropped_; }
+
+      private:
+        struct Slot
+        {
+            std::atomic<std::uint64_t> sequence;
+            std::uint32_t size;
+            char data[kMaxLineSize];
+        };
+
+        void WriterThread();
+        std::size_t Drain(char* batch, std::size_t batch_size);
+
+        std::FILE* file_;
+        std::size_t mask_;
+        std::unique_ptr<Slot[]> slots_;
+
+        alignas(64) std::atomic<std::uint64_t> enqueue_pos_;
+        alignas(64) std::atomic<std::uint64_t> dequeue_pos_;
+        alignas(64) std::atomic<std::uint64_t> dropped_;
+
+        std::atomic_bool terminate_;
+        std::thread writer_thread_;
+    };
+
+    /**
+     * @brief Create a logger that writes to stderr through an AsyncLogSink and make it the default logger
+     */
+    std::shared_ptr<spdlog::logger> CreateAsyncLogger(const std::string& name, std::size_t queue_size = 16384);
+
+    /**
+     * @brief Flush the default async logger and report how many lines it dropped
+     */
+    void ReportAsyncLogger(const std::string& endpoint_id);
+} // namespace qperf
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <quicr/client.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace qperf {
+    enum class ControlResult : std::uint8_t
+    {
+        kPending,
+        kOk,
+        kFailed
+    };
+
+    /**
+     * @brief Request and response time of one announce or subscribe
+     * @details Started by the thread issuing the request and completed once by the transport thread, the
+     *          first response wins. Times are monotonic microseconds.
+     */
+    class ControlTiming
+    {
+      public:
+        void Start();
+        void Respond(bool ok);
+
+        ControlResult Result() const noexcept { return result_.load(std::memory_order_acquire); }
+        std::uint64_t StartTime() const noexcept { return start_us_; }
+        std::uint64_t ResponseTime() const noexcept { return response_us_; }
+        std::uint64_t Latency() const noexcept { return response_us_ - start_us_; }
+
+      private:
+        std::atomic<ControlResult> result_{ ControlResult::kPending };
+        std::uint64_t start_us_{ 0 };
+        std::uint64_t response_us_{ 0 };
+    };
+
+    /**
+     * @brief Publish track that only announces, used to load the relay control plane
+     */
+    class ControlPublishTrackHandler : public quicr::PublishTrackHandler
+    {
+      public:
+        explicit ControlPublishTrackHandler(const quicr::FullTrackName& full_track_name);
+
+        void StatusChanged(Status status) override;
+
+        ControlTiming& Timing() noexcept { return timing_; }
+
+      private:
+        ControlTiming timing_;
+    };
+
+    /**
+     * @brief Subscribe track that only subscribes, used to load the relay control plane
+     */
+    class ControlSubscribeTrackHandler : public quicr::SubscribeTrackHandler
+    {
+      public:
+        explicit ControlSubscribeTrackHandler(const quicr::FullTrackName& full_track_name);
+
+        void StatusChanged(Status status) override;
+
+        ControlTiming& Timing() noexcept { return timing_; }
+
+      private:
+        ControlTiming timing_;
+    };
+} // namespace qperf
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <quicr/client.h>
+
+#include "inicpp.h"
+#include "qperf.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qperf {
+    /**
+     * @brief Cached range of a track retrieved by a fetch benchmark client
+     * @details The range is whole groups, fetch_groups groups starting at fetch_start_group. The publisher
+     *          must have published the range and the track ttl must keep it cached until fetch_delay.
+     */
+    struct FetchConfig
+    {
+        std::uint64_t delay;       // ms after the client is ready before fetching
+        std::uint64_t start_group; // first group fetched
+        std::uint64_t groups;      // number of groups fetched
+        std::uint64_t timeout;     // ms without an object before an incomplete fetch is given up
+    };
+
+    bool PopulateFetchConfig(const ini::IniSection& section, FetchConfig& config);
+
+    class PerfFetchTrackHandler : public quicr::FetchTrackHandler
+    {
+      private:
+        PerfFetchTrackHandler(const PerfConfig& perf_config,
+                              const FetchConfig& fetch_config,
+                              std::uint32_t test_identifier,
+                              std::uint32_t fetch_index);
+
+      public:
+        static std::shared_ptr<PerfFetchTrackHandler> Create(const std::string& section_name,
+                                                             ini::IniFile& inif,
+                                                             std::uint32_t test_identifier,
+                                                             std::uint32_t fetch_index);
+
+        // A fully received range goes quiet this long before the end group, of unknown length, is complete
+        static constexpr std::uint64_t kEndGroupSettleMs = 250;
+
+        void ObjectReceived(const quicr::ObjectHeaders& object_header, quicr::BytesSpan data_span) override;
+        void StatusChanged(Status status) override;
+
+        /**
+         * @brief Mark the time the fetch is sent, completion times are measured from it
+         */
+        void Fetching();
+
+        /**
+         * @brief Complete the fetch once it goes quiet after the objects of every group have arrived
+         * @details Groups may be cut short by new group requests. The length of a group is carried in the
+         *          test header of the next group's objects, the length of the end group is not known within
+         *          the range. When every other group is complete and the end group has objects, the fetch
+         *          completes after kEndGroupSettleMs without an object, otherwise it is given up after the
+         *          fetch timeout.
+         * @returns true if the fetch is complete, including by timeout
+         */
+        bool CheckComplete();
+
+        /**
+         * @brief Log the fetch results, once per fetch
+         */
+        void Report();
+
+        bool IsComplete() const noexcept { return complete_; }
+        std::string TestName() const { return perf_config_.test_name; }
+        std::chrono::milliseconds Delay() const noexcept { return std::chrono::milliseconds(fetch_config_.delay); }
+        std::uint64_t TotalObjects() const noexcept { return objects_; }
+
+      private:
+        PerfConfig perf_config_;
+        FetchConfig fetch_config_;
+        std::uint32_t test_identifier_;
+        std::uint32_t fetch_index_;
+
+        // Objects received and known length of each group of the range, only touched by the transport thread
+        std::vector<std::uint64_t> group_objects_;
+        std::vector<std::uint64_t> group_lengths_;
+
+        std::atomic_bool complete_;
+        std::atomic_bool timed_out_;
+        bool reported_;
+
+        // Written by the transport thread, read by the client thread
+        std::atomic<std::uint64_t> fetch_time_;
+        std::atomic<std::uint64_t> first_object_time_;
+        std::atomic<std::uint64_t> last_object_time_;
+        std::atomic<std::uint64_t> objects_;
+        std::atomic<std::uint64_t> bytes_;
+        std::atomic<std::uint64_t> max_object_age_;
+        std::atomic<std::uint64_t> expected_objects_;
+        std::atomic_bool end_group_open_; // every group but the end group is complete, the end group started
+    };
+} // namespace qperf
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace qperf {
+    /**
+     * @brief Log-linear histogram of non-negative values
+     * @details Values are bucketed by power of two with kSubBuckets linear sub buckets per power. The
+     *          relative error of a percentile is bounded by 1/kSubBuckets, memory is fixed and recording
+     *          is a few instructions. Not thread safe, each histogram has a single writer.
+     */
+    class Histogram
+    {
+      public:
+        static constexpr std::size_t kSubBucketBits = 4;
+        static constexpr std::size_t kSubBuckets = std::size_t(1) << kSubBucketBits;
+        static constexpr std::size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+        Histogram() { Reset(); }
+
+        void Reset()
+        {
+            counts_.fill(0);
+            count_ = 0;
+            total_ = 0;
+            min_ = std::numeric_limits<std::uint64_t>::max();
+            max_ = 0;
+        }
+
+        void Record(std::uint64_t value)
+        {
+            counts_[BucketIndex(value)] += 1;
+            count_ += 1;
+            total_ += value;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+        }
+
+        /**
+         * @brief Record a signed value, negative values are counted as zero
+         */
+        void RecordSigned(std::int64_t value) { Record(value > 0 ? static_cast<std::uint64_t>(value) : 0); }
+
+        void Merge(const Histogram& other)
+        {
+            for (std::size_t i = 0; i < kBuckets; ++i) {
+                counts_[i] += other.counts_[i];
+            }
+            count_ += other.count_;
+            total_ += other.total_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+        }
+
+        /**
+         * @brief Value at percentile, in the range 0-100
+         */
+        std::uint64_t Percentile(double percentile) const
+        {
+            if (count_ == 0) {
+                return 0;
+            }
+
+            const auto target =
+              std::max<std::uint64_t>(1, static_cast<std::uint64_t>(percentile / 100.0 * static_cast<double>(count_)));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < kBuckets; ++i) {
+                seen += counts_[i];
+                if (seen >= target) {
+                    return std::clamp(BucketValue(i), min_, max_);
+                }
+            }
+
+            return max_;
+        }
+
+        std::uint64_t Count() const noexcept { return count_; }
+        std::uint64_t Min() const noexcept { return count_ ? min_ : 0; }
+        std::uint64_t Max() const noexcept { return max_; }
+        double Mean() const noexcept
+        {
+            return count_ ? static_cast<double>(total_) / static_cast<double>(count_) : 0.0;
+        }
+
+      private:
+        static std::size_t BucketIndex(std::uint64_t value)
+        {
+            if (value < kSubBuckets) {
+                return static_cast<std::size_t>(value);
+            }
+
+            const std::size_t shift = std::bit_width(value) - 1 - kSubBucketBits;
+            const std::size_t sub_bucket = static_cast<std::size_t>(value >> shift) - kSubBuckets;
+            return (shift + 1) * kSubBuckets + sub_bucket;
+        }
+
+        /**
+         * @brief Midpoint of the values that map to a bucket
+         */
+        static std::uint64_t BucketValue(std::size_t index)
+        {
+            if (index < kSubBuckets) {
+                return index;
+            }
+
+            const std::size_t shift = index / kSubBuckets - 1;
+            const std::uint64_t lower = static_cast<std::uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+            return lower + ((std::uint64_t(1) << shift) >> 1);
+        }
+
+        std::array<std::uint64_t, kBuckets> counts_;
+        std::uint64_t count_;
+        std::uint64_t total_;
+        std::uint64_t min_;
+        std::uint64_t max_;
+    };
+} // namespace qperf
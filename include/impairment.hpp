@@ -0,0 +1,123 @@
+#pragma once
+
+#include "inicpp.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace qperf {
+    enum class DelayDistribution : uint8_t
+    {
+        kConstant,
+        kUniform,
+        kNormal,
+        kPareto
+    };
+
+    enum class LossModel : uint8_t
+    {
+        kNone,
+        kBernoulli,
+        kGilbertElliott
+    };
+
+    /**
+     * @brief Impairment applied for one phase of a schedule
+     * @details A phase is active from its start_time until the start_time of the next phase.
+     *          Percentages are in the range 0-100.
+     */
+    struct ImpairmentConfig
+    {
+        std::string name;
+        std::uint64_t start_time;              // ms since the proxy started
+        double delay;                          // one way delay in ms
+        double jitter;                         // ms, meaning depends on delay_distribution
+        DelayDistribution delay_distribution;
+        LossModel loss_model;
+        double loss;                           // Bernoulli loss percent
+        double ge_p;                           // Gilbert-Elliott good -> bad transition percent
+        double ge_r;                           // Gilbert-Elliott bad -> good transition percent
+        double ge_loss_good;                   // loss percent while in the good state
+        double ge_loss_bad;                    // loss percent while in the bad state
+        double reorder;                        // percent of packets held back by reorder_delay
+        double reorder_delay;                  // ms
+        std::uint64_t rate;                    // bottleneck rate in Kbps, 0 is unlimited
+        double queue_limit;                    // ms of queued data at the bottleneck before tail drop
+    };
+
+    struct ImpairmentStats
+    {
+        std::uint64_t packets;
+        std::uint64_t bytes;
+        std::uint64_t dropped_loss;
+        std::uint64_t dropped_queue;
+        std::uint64_t reordered;
+        std::uint64_t forwarded;
+        std::uint64_t total_delay_us;
+        std::uint64_t max_delay_us;
+    };
+
+    /**
+     * @brief Decides the fate of each packet in one direction of the impairment proxy
+     * @details Models a rate limited bottleneck queue followed by a delay line. The engine does not
+     *          allocate per packet, it only returns the time the packet should be released.
+     */
+    class ImpairmentEngine
+    {
+      public:
+        using Clock = std::chrono::steady_clock;
+
+        ImpairmentEngine(const std::vector<ImpairmentConfig>& schedule, std::uint64_t seed);
+
+        /**
+         * @brief Apply the active impairment to a packet
+         * @returns time the packet should be forwarded or nullopt if the packet is dropped
+         */
+        std::optional<Clock::time_point> Apply(Clock::time_point now, std::size_t packet_size);
+
+        /**
+         * @brief Record a packet dropped before the engine because the proxy has no room to queue it
+         */
+        void DroppedQueue(std::size_t packet_size);
+
+        /**
+         * @brief Record that a packet released by the engine was sent
+         */
+        void Forwarded(std::chrono::microseconds delay);
+
+        const ImpairmentStats& Stats() const noexcept { return stats_; }
+        const ImpairmentConfig& ActivePhase() const noexcept { return schedule_[phase_index_]; }
+
+        /**
+         * @brief Move to the phase that is active at now
+         * @returns true if the active phase changed
+         */
+        bool UpdatePhase(Clock::time_point now);
+
+      private:
+        double SampleDelay(const ImpairmentConfig& config);
+        bool SampleLoss(const ImpairmentConfig& config);
+        bool Chance(double percent);
+
+        std::vector<ImpairmentConfig> schedule_;
+        std::size_t phase_index_;
+        std::mt19937_64 rng_;
+        std::uniform_real_distribution<double> uniform_;
+        bool ge_bad_state_;
+        Clock::time_point start_time_;
+        Clock::time_point link_free_time_;
+        ImpairmentStats stats_;
+    };
+
+    /**
+     * @brief Build the impairment schedule from an ini file
+     * @details Each section is a phase, sorted by start_time. Missing keys default to no impairment.
+     */
+    bool PopulateImpairmentSchedule(ini::IniFile& inif, std::vector<ImpairmentConfig>& schedule);
+
+    std::string ImpairmentToString(const ImpairmentConfig& config);
+} // namespace qperf
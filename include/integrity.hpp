@@ -0,0 +1,54 @@
+#pragma once
+
+#include "qperf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace qperf {
+    /**
+     * @brief Integrity header following the ObjectTestHeader when the integrity mode is not none
+     * @details The check covers the payload after this header. For crc32c it is the CRC32C of the
+     *          payload seeded with the group and object id. For pattern the payload is generated from
+     *          the group and object id and check is zero.
+     */
+    struct ObjectIntegrityHeader
+    {
+        std::uint64_t payload_length;
+        std::uint32_t check;
+        std::uint32_t reserved;
+    };
+
+    enum class IntegrityResult : uint8_t
+    {
+        kUnchecked,
+        kOk,
+        kCorrupt,
+        kSizeMismatch
+    };
+
+    constexpr std::size_t kIntegrityOffset = sizeof(ObjectTestHeader);
+    constexpr std::size_t kIntegrityMinSize = sizeof(ObjectTestHeader) + sizeof(ObjectIntegrityHeader);
+
+    /**
+     * @brief CRC32C (Castagnoli)
+     * @details Uses the SSE4.2 or ARMv8 CRC instructions when the CPU has them, table driven otherwise.
+     */
+    std::uint32_t Crc32c(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0);
+
+    /**
+     * @brief Fill the object with its integrity header and, in pattern mode, its payload
+     * @details Objects smaller than kIntegrityMinSize are left as is and are not checked.
+     */
+    void SealObject(IntegrityMode mode,
+                    std::uint64_t group_id,
+                    std::uint64_t object_id,
+                    std::uint8_t* data,
+                    std::size_t size);
+
+    IntegrityResult VerifyObject(IntegrityMode mode,
+                                 std::uint64_t group_id,
+                                 std::uint64_t object_id,
+                                 const std::uint8_t* data,
+                                 std::size_t size);
+} // namespace qperf
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace qperf {
+    /**
+     * @brief Runs delayed subscribes for late join tests
+     * @details Client status callbacks run on the transport thread and must not sleep, so subscribes with a
+     *          join delay are handed to a single background thread that runs them when they are due. The
+     *          thread is started by the first Schedule call.
+     */
+    class JoinScheduler
+    {
+      public:
+        JoinScheduler();
+        ~JoinScheduler();
+
+        void Schedule(std::chrono::milliseconds delay, std::function<void()> join);
+
+        /**
+         * @brief Stop the scheduler thread, joins that are not due yet are discarded
+         */
+        void Stop();
+
+      private:
+        void SchedulerThread();
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> pending_;
+        bool terminate_;
+        std::thread thread_;
+    };
+} // namespace qperf
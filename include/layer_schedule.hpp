@@ -0,0 +1,79 @@
+#pragma once
+
+#include "inicpp.h"
+#include "qperf.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace qperf {
+    /**
+     * @brief Layer of a layered publish track, e.g. a temporal layer of SVC video
+     * @details Each layer is published as its own subgroup of the group, with its own object size and
+     *          priority. The layer publishes on the ticks of the track's time_interval where
+     *          tick % interval == offset, counted from the start of the group. A group is
+     *          objects_per_group ticks long.
+     */
+    struct LayerConfig
+    {
+        std::uint32_t object_size;
+        std::uint32_t interval;
+        std::uint32_t offset;
+        std::uint8_t priority;
+    };
+
+    /**
+     * @brief Layer of every object position in a group, precomputed from the track config
+     * @details Objects are numbered in publish order within a group across all layers, so a position maps
+     *          to a layer and to the index of the object within that layer's part of the group. Publishers
+     *          and subscribers build the same schedule from the same config. An empty schedule means a
+     *          single layer track, published as before.
+     */
+    class LayerSchedule
+    {
+      public:
+        static constexpr std::size_t kMaxLayers = 8;
+
+        struct Slot
+        {
+            std::uint8_t layer;
+            std::uint32_t ticks_after; // ticks the publisher waits after this object, 0 is back to back
+            std::uint32_t layer_index; // index of the object among the objects of its layer in the group
+        };
+
+        LayerSchedule() = default;
+
+        static LayerSchedule Build(const ini::IniSection& section, const PerfConfig& perf_config);
+
+        bool Empty() const noexcept { return slots_.empty(); }
+        std::size_t Layers() const noexcept { return layers_.size(); }
+        const LayerConfig& Layer(std::size_t layer) const noexcept { return layers_[layer]; }
+
+        std::uint64_t ObjectsPerGroup() const noexcept { return slots_.size(); }
+        std::uint32_t LayerObjectsPerGroup(std::size_t layer) const noexcept { return layer_objects_[layer]; }
+        std::uint32_t MaxSize() const noexcept { return max_size_; }
+
+        /**
+         * @brief Objects of a layer among the first objects of a group, the layer's part of a group cut short
+         */
+        std::uint32_t LayerObjectsIn(std::size_t layer, std::uint64_t objects) const noexcept
+        {
+            const auto count = std::min<std::uint64_t>(objects, slots_.size());
+            const auto end = slots_.begin() + static_cast<std::ptrdiff_t>(count);
+            return static_cast<std::uint32_t>(
+              std::count_if(slots_.begin(), end, [layer](const Slot& slot) { return slot.layer == layer; }));
+        }
+
+        /**
+         * @brief Slot of an object id, ids past the end of the group wrap to the next group
+         */
+        const Slot& At(std::uint64_t object_id) const noexcept { return slots_[object_id % slots_.size()]; }
+
+      private:
+        std::vector<LayerConfig> layers_;
+        std::vector<std::uint32_t> layer_objects_;
+        std::vector<Slot> slots_;
+        std::uint32_t max_size_{ 0 };
+    };
+} // namespace qperf
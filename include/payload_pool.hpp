@@ -0,0 +1,65 @@
+#pragma once
+
+#include "spsc_ring.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace qperf {
+    /**
+     * @brief Preallocated payload buffers of a publish track
+     * @details Buffers are created up front and filled with the base pattern once. Acquire hands out a
+     *          buffer that goes back to the pool when its handle is destroyed, so the steady state
+     *          publish path does not allocate. Buffers are acquired by one thread and released by one
+     *          thread at a time, the free list is a lock-free single producer/single consumer ring.
+     */
+    class PayloadPool
+    {
+      public:
+        class Buffer
+        {
+          public:
+            Buffer() = default;
+            Buffer(PayloadPool* pool, std::uint32_t index, std::size_t size);
+            Buffer(Buffer&& other) noexcept;
+            Buffer& operator=(Buffer&& other) noexcept;
+            ~Buffer();
+
+            Buffer(const Buffer&) = delete;
+            Buffer& operator=(const Buffer&) = delete;
+
+            explicit operator bool() const noexcept { return pool_ != nullptr; }
+
+            std::span<std::uint8_t> Span() const noexcept;
+
+          private:
+            PayloadPool* pool_{ nullptr };
+            std::uint32_t index_{ 0 };
+            std::size_t size_{ 0 };
+        };
+
+        PayloadPool(std::size_t buffer_count, std::size_t buffer_size);
+
+        /**
+         * @brief Take a buffer of at least size bytes from the pool
+         * @details An object larger than the buffer size grows the buffer, allocating, and the buffer is
+         *          shrunk back when released, so the rare outlier does not hold memory in every buffer.
+         * @returns an empty handle when every buffer is in use
+         */
+        Buffer Acquire(std::size_t size);
+
+        std::size_t BufferCount() const noexcept { return buffers_.size(); }
+        std::uint64_t Exhausted() const noexcept { return exhausted_; }
+        std::uint64_t Oversized() const noexcept { return oversized_; }
+
+      private:
+        void Release(std::uint32_t index);
+
+        std::vector<std::vector<std::uint8_t>> buffers_;
+        SpscRing<std::uint32_t> free_;
+        std::size_t buffer_size_;
+        std::uint64_t exhausted_{ 0 };
+        std::uint64_t oversized_{ 0 };
+    };
+} // namespace qperf
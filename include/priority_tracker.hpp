@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace qperf {
+    /**
+     * @brief Detects priority inversions across the subscribe tracks of a client
+     * @details Keeps the latest publish time received per priority. An object is inverted when an object
+     *          of a lower priority (a higher value) that was published after it arrived first, meaning the
+     *          path delivered the less important object ahead of it. Publish times within
+     *          kInversionSlackUs are treated as simultaneous so tracks publishing on the same tick do not
+     *          count. Called from the transport receive thread, lock free.
+     */
+    class PriorityTracker
+    {
+      public:
+        static constexpr std::uint64_t kInversionSlackUs = 1000;
+
+        static PriorityTracker& Instance()
+        {
+            static PriorityTracker instance;
+            return instance;
+        }
+
+        /**
+         * @brief Record a received object
+         * @returns true if the object arrived after a later published object of a lower priority
+         */
+        bool Received(std::uint8_t priority, std::uint64_t publish_time) noexcept
+        {
+            auto& latest = latest_publish_[priority];
+            auto current = latest.load(std::memory_order_relaxed);
+            while (current < publish_time &&
+                   !latest.compare_exchange_weak(current, publish_time, std::memory_order_relaxed)) {
+            }
+
+            auto lowest = lowest_priority_.load(std::memory_order_relaxed);
+            while (lowest < priority &&
+                   !lowest_priority_.compare_exchange_weak(lowest, priority, std::memory_order_relaxed)) {
+            }
+
+            for (std::uint32_t p = priority + 1u; p <= lowest; ++p) {
+                if (latest_publish_[p].load(std::memory_order_relaxed) > publish_time + kInversionSlackUs) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+      private:
+        PriorityTracker()
+          : lowest_priority_(0)
+        {
+            for (auto& latest : latest_publish_) {
+                latest.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        std::array<std::atomic<std::uint64_t>, 256> latest_publish_;
+        std::atomic<std::uint8_t> lowest_priority_;
+    };
+} // namespace qperf
@@ -3,26 +3,51 @@
 #include <cstdint>
 #include <quicr/client.h>
 
+#include "arrival_model.hpp"
+#include "histogram.hpp"
 #include "inicpp.h"
+#include "layer_schedule.hpp"
+#include "payload_pool.hpp"
 #include "qperf.hpp"
+#include "self_profiler.hpp"
+#include "seqlock.hpp"
+#include "size_model.hpp"
+#include <array>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <span>
 
 namespace qperf {
+    /**
+     * @brief Publish bitrate accumulated from the track metrics samples
+     */
+    struct PublishBitrateMetrics
+    {
+        std::uint64_t max_publish_bitrate;
+        std::uint64_t min_publish_bitrate;
+        std::uint64_t avg_publish_bitrate;
+        std::uint32_t metric_samples;
+        std::uint64_t bitrate_total;
+    };
+
     class PerfPublishTrackHandler : public quicr::PublishTrackHandler
     {
       private:
-        PerfPublishTrackHandler(const PerfConfig&);
+        PerfPublishTrackHandler(const PerfConfig&, const SizeModelConfig&, const ArrivalConfig&, LayerSchedule);
 
       public:
         static std::shared_ptr<PerfPublishTrackHandler> Create(const std::string& section_name,
                                                                ini::IniFile& inif,
-                                                               std::uint32_t instance_id);
+                                                               std::uint32_t instance_id,
+                                                               std::uint8_t relay_index = 0);
         void StatusChanged(Status status) override;
         void MetricsSampled(const quicr::PublishTrackMetrics& metrics) override;
 
         qperf::TestMode TestMode() { return test_mode_; }
 
-        std::chrono::time_point<std::chrono::system_clock> PublishObjectWithMetrics(quicr::BytesSpan object_span);
+        std::uint64_t PublishObjectWithMetrics(std::span<std::uint8_t> object_span);
         std::uint64_t PublishTestComplete();
 
         std::thread SpawnWriter();
@@ -31,18 +56,64 @@ namespace qperf {
 
         bool IsComplete() { return (test_mode_ == qperf::TestMode::kComplete); }
 
+        const WakeupStats& GetWakeupStats() const noexcept { return wakeup_stats_; }
+        std::uint64_t PublishedObjects() const noexcept { return publish_track_metrics_.objects_published; }
+
       private:
+        // Large enough for every PublishObjectStatus value, unknown values share the last slot
+        static constexpr std::size_t kPublishStatusSlots = 32;
+
+        PublishObjectStatus TimedPublishObject(const quicr::ObjectHeaders& object_headers,
+                                               quicr::BytesSpan object_span);
+        void ReportPublishCalls();
+        std::uint64_t PublishRunningObject(std::span<std::uint8_t> object_span);
+        void ReplayTrace();
+        void SetPaused(bool paused);
+        void WaitWhilePaused(std::chrono::steady_clock::time_point deadline);
+        void ReportSuspensions();
+        void RecordWakeup(std::chrono::steady_clock::duration lateness, std::chrono::steady_clock::duration gap);
+
         PerfConfig perf_config_;
+        SizeSchedule size_schedule_;
+        ArrivalSchedule arrival_schedule_;
+        LayerSchedule layer_schedule_;
+        PayloadPool payload_pool_;
         std::atomic_bool terminate_;
         uint64_t last_bytes_;
-        qperf::TestMode test_mode_;
+        std::atomic<qperf::TestMode> test_mode_;
         uint64_t group_id_;
         uint64_t object_id_;
 
+        // Last published group and object, the length of a group is sent with the objects of the next one
+        std::optional<std::uint64_t> published_group_id_;
+        std::uint64_t published_object_id_;
+        std::uint16_t previous_group_objects_;
+
         std::thread write_thread_;
-        std::chrono::time_point<std::chrono::system_clock> last_metric_time_;
+        std::chrono::steady_clock::time_point last_metric_time_;
 
+        // Only touched by the writer thread
         qperf::TestMetrics test_metrics_;
-        std::mutex mutex_;
+
+        // Only touched by MetricsSampled, published to the writer through the seqlock
+        PublishBitrateMetrics bitrate_metrics_;
+        SeqLock<PublishBitrateMetrics> bitrate_snapshot_;
+
+        WakeupStats wakeup_stats_;
+
+        // PublishObject call latency (ns) and result counts, only touched by the writer thread
+        Histogram publish_call_latency_;
+        std::array<std::uint64_t, kPublishStatusSlots> publish_status_counts_;
+
+        // Writer suspension while the relay has paused the track or there are no subscribers
+        std::atomic_bool paused_;
+        std::mutex pause_mutex_;
+        std::condition_variable pause_cv_;
+        std::uint64_t pauses_;
+        std::chrono::steady_clock::duration paused_time_;
+
+        // Monotonic time (us) of a pending new group request, 0 when none
+        std::atomic<std::uint64_t> new_group_requested_us_;
+        Histogram new_group_latency_;
     };
 } // namespace qperf
@@ -7,6 +7,13 @@
 #include <cstdint>
 
 namespace qperf {
+    enum class IntegrityMode : uint8_t
+    {
+        kNone,
+        kPattern,
+        kCrc32c
+    };
+
     struct PerfConfig
     {
         std::string test_name;
@@ -21,6 +28,12 @@ namespace qperf {
         uint64_t start_delay;
         uint64_t total_transmit_time;
         uint64_t total_test_time;
+        std::string trace_file; // publish object timing and sizes replayed from a trace, empty when synthetic
+        IntegrityMode integrity;
+        uint32_t payload_buffers; // publish payload buffers preallocated per track
+        uint64_t join_delay;      // ms after the client is ready before subscribing
+        quicr::messages::FilterType filter_type;
+        uint8_t relay_index; // relay the client is connected to, set by the client
     };
 
     enum class TestMode : uint8_t
@@ -50,22 +63,59 @@ namespace qperf {
     struct ObjectTestHeader
     {
         TestMode test_mode;
+        std::uint8_t relay_index;             // relay of the publisher, fits in the padding before time
+        std::uint16_t previous_group_objects; // objects of the group before this one, 0 when not known
+        std::uint32_t ttl;                    // ms, the object TTL so subscribers can detect stale deliveries
         std::uint64_t time;
     };
+    static_assert(sizeof(ObjectTestHeader) == 16, "the test header fields fit in the padding before time");
 
     struct ObjectTestComplete
     {
         TestMode test_mode;
+        std::uint8_t relay_index;
+        std::uint16_t previous_group_objects;
+        std::uint32_t ttl;
         std::uint64_t time;
         TestMetrics test_metrics;
     };
 
+    /**
+     * @brief Read an optional field from a config section
+     * @details Returns default_value when the key is not present in the section
+     */
+    template<typename T>
+    inline T ValueOrDefault(const ini::IniSection& section, const std::string& key, const T& default_value)
+    {
+        auto it = section.find(key);
+        if (it == section.end()) {
+            return default_value;
+        }
+        return it->second.as<T>();
+    }
+
     inline quicr::FullTrackName MakeFullTrackName(const std::string& track_namespace,
                                                   const std::string& track_name) noexcept
     {
         return { quicr::TrackNamespace{ track_namespace }, { track_name.begin(), track_name.end() } };
     }
 
+    inline const char* FilterTypeName(quicr::messages::FilterType filter_type) noexcept
+    {
+        switch (filter_type) {
+            case quicr::messages::FilterType::kNextGroupStart:
+                return "next_group_start";
+            case quicr::messages::FilterType::kLargestObject:
+                return "largest_object";
+            case quicr::messages::FilterType::kAbsoluteStart:
+                return "absolute_start";
+            case quicr::messages::FilterType::kAbsoluteRange:
+                return "absolute_range";
+            default:
+                return "unknown";
+        }
+    }
+
     inline bool PopulateScenarioFields(const std::string section_name,
                                        std::uint32_t instance_id,
                                        ini::IniFile& inif,
@@ -102,6 +152,35 @@ namespace qperf {
         perf_config.start_delay = section["start_delay"].as<std::uint64_t>();
         perf_config.total_transmit_time = section["total_transmit_time"].as<std::uint64_t>();
         perf_config.total_test_time = perf_config.total_transmit_time + perf_config.start_delay;
+        perf_config.trace_file = ValueOrDefault<std::string>(section, "trace_file", "");
+        perf_config.payload_buffers = ValueOrDefault<std::uint32_t>(section, "payload_buffers", 4);
+
+        const auto integrity_ini_str = ValueOrDefault<std::string>(section, "integrity", "none");
+        if (integrity_ini_str == "crc32c") {
+            perf_config.integrity = IntegrityMode::kCrc32c;
+        } else if (integrity_ini_str == "pattern") {
+            perf_config.integrity = IntegrityMode::kPattern;
+        } else {
+            perf_config.integrity = IntegrityMode::kNone;
+            if (integrity_ini_str != "none") {
+                SPDLOG_WARN("Invalid integrity mode in scenario. Using default `none`");
+            }
+        }
+
+        perf_config.relay_index = 0;
+        perf_config.join_delay = ValueOrDefault<std::uint64_t>(section, "join_delay", 0);
+
+        // Absolute filters need a start location, which this client has no way to pass with the subscribe
+        const auto filter_ini_str = ValueOrDefault<std::string>(section, "filter_type", "largest_object");
+        if (filter_ini_str == "next_group_start") {
+            perf_config.filter_type = quicr::messages::FilterType::kNextGroupStart;
+        } else {
+            perf_config.filter_type = quicr::messages::FilterType::kLargestObject;
+            if (filter_ini_str != "largest_object") {
+                SPDLOG_WARN("Unsupported filter type '{}' in scenario. Using default `largest_object`",
+                            filter_ini_str);
+            }
+        }
 
         SPDLOG_INFO("--------------------------------------------");
         SPDLOG_INFO("Test config:");
@@ -117,6 +196,12 @@ namespace qperf {
         SPDLOG_INFO("             start_delay {}", perf_config.start_delay);
         SPDLOG_INFO("         total test time {}", perf_config.total_test_time);
         SPDLOG_INFO("           transmit time {}", perf_config.total_transmit_time);
+        SPDLOG_INFO("               integrity {}", integrity_ini_str);
+        SPDLOG_INFO("              join delay {}", perf_config.join_delay);
+        SPDLOG_INFO("             filter type {}", FilterTypeName(perf_config.filter_type));
+        if (!perf_config.trace_file.empty()) {
+            SPDLOG_INFO("              trace file {}", perf_config.trace_file);
+        }
         SPDLOG_INFO("--------------------------------------------");
 
         parsed = true;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <string>
+
+namespace qperf {
+    struct ReconnectConfig
+    {
+        bool enabled;
+        std::chrono::milliseconds initial_backoff;
+        std::chrono::milliseconds max_backoff;
+    };
+
+    /**
+     * @brief Reconnect with backoff after the relay connection is lost, and measure the outages
+     * @details The client status callback reports Lost and Ready, the main loop calls Poll to make the
+     *          reconnect attempts once their backoff expired. The backoff doubles per failed attempt up to
+     *          the maximum, with up to half of it randomized so clients of a restarted relay spread out.
+     *          When disabled, Lost returns false and the client terminates as before.
+     */
+    class Reconnector
+    {
+      public:
+        static constexpr auto kConnectTimeout = std::chrono::seconds(10);
+
+        explicit Reconnector(const ReconnectConfig& config);
+
+        bool Enabled() const noexcept { return enabled_; }
+
+        /**
+         * @brief The connection was lost or a connect attempt failed
+         * @returns false if reconnecting is disabled
+         */
+        bool Lost();
+
+        /**
+         * @brief The connection is ready
+         * @returns epoch time (us) the outage started when this ends one, 0 on the first connect
+         */
+        std::uint64_t Ready();
+
+        /**
+         * @brief Make a reconnect attempt if one is due
+         */
+        template<typename Client>
+        void Poll(Client& client)
+        {
+            if (!AttemptDue()) {
+                return;
+            }
+
+            // Disconnect reports the connection lost again, which is ignored until Connecting
+            client.Disconnect();
+            Connecting();
+            try {
+                client.Connect();
+            } catch (const std::exception& e) {
+                SPDLOG_WARN("Reconnect attempt failed: {}", e.what());
+                Lost();
+            }
+        }
+
+        /**
+         * @brief Log the outages, once at the end of the test
+         */
+        void Report(const std::string& endpoint_id);
+
+      private:
+        enum class State
+        {
+            kConnected,
+            kLost,
+            kConnecting
+        };
+
+        bool AttemptDue();
+        void Connecting();
+        std::chrono::milliseconds NextBackoff();
+
+        const bool enabled_;
+        const std::chrono::milliseconds initial_backoff_;
+        const std::chrono::milliseconds max_backoff_;
+
+        std::mutex mutex_;
+        State state_;
+        bool connected_once_;
+        std::chrono::milliseconds backoff_;
+        std::chrono::steady_clock::time_point next_attempt_;
+        std::minstd_rand jitter_;
+
+        std::uint64_t outage_start_us_;
+        std::uint32_t attempts_;
+        std::uint32_t outages_;
+        std::uint64_t total_outage_us_;
+        std::uint64_t max_outage_us_;
+    };
+} // namespace qperf
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qperf {
+    enum class RelayPlacement : std::uint8_t
+    {
+        kRoundRobin,
+        kPinned,
+        kRandom
+    };
+
+    /**
+     * @brief Relay a client connects to, out of the relays given to the test
+     * @details The index identifies the relay in results, publishers put it in the test header so the
+     *          subscribers can break their results down per publisher and subscriber relay pair.
+     */
+    struct RelaySelection
+    {
+        std::uint8_t index;
+        std::string uri;
+    };
+
+    /**
+     * @brief Split a comma separated list of relay URIs
+     */
+    std::vector<std::string> ParseRelayUris(const std::string& uris);
+
+    RelayPlacement ParseRelayPlacement(const std::string& placement);
+
+    /**
+     * @brief Pick the relay of a client
+     * @param uris          Comma separated relay URIs
+     * @param placement     round_robin (by client index), pinned (to pinned_index) or random
+     * @param client_index  Test or instance id of the client
+     * @param pinned_index  Relay index used by the pinned placement
+     */
+    RelaySelection SelectRelay(const std::string& uris,
+                               const std::string& placement,
+                               std::uint32_t client_index,
+                               std::uint32_t pinned_index);
+} // namespace qperf
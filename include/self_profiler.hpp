@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace qperf {
+    /**
+     * @brief Publish loop wake-up lateness against the publish schedule
+     */
+    struct WakeupStats
+    {
+        std::uint64_t samples;
+        std::uint64_t total_lateness_us;
+        std::uint64_t max_lateness_us;
+        std::uint64_t late_wakeups; // woke up more than half the scheduled gap late
+    };
+
+    /**
+     * @brief Load generated by the client that the profiler overhead is divided by
+     */
+    struct ClientLoad
+    {
+        std::uint64_t objects;
+        WakeupStats wakeup;
+    };
+
+    /**
+     * @brief Samples the CPU usage of the qperf process to detect when the client itself is saturated
+     * @details Samples getrusage and, on Linux, per thread CPU time and run queue delay from /proc.
+     *          A result is invalid when any sample shows the process or a single thread above the
+     *          saturation threshold or when the publish loop missed its schedule.
+     */
+    class SelfProfiler
+    {
+      public:
+        SelfProfiler(std::chrono::milliseconds sample_interval, double saturation_threshold);
+        ~SelfProfiler();
+
+        void Start();
+        void Stop();
+
+        /**
+         * @brief Log the final profile and validity of the results
+         * @returns true if the client was not saturated during the test
+         */
+        bool Report(const std::string& endpoint_id, const ClientLoad& load);
+
+      private:
+        struct ThreadSample
+        {
+            std::uint64_t cpu_us;
+            std::uint64_t run_delay_us;
+        };
+
+        void SampleThread();
+        void Sample(bool log);
+        double SampleThreads(double wall_us, bool log);
+
+        std::chrono::milliseconds sample_interval_;
+        double saturation_threshold_;
+        std::atomic_bool terminate_;
+        std::thread sample_thread_;
+        std::mutex mutex_;
+
+        std::chrono::steady_clock::time_point start_time_;
+        std::chrono::steady_clock::time_point last_sample_time_;
+        std::uint64_t start_cpu_user_us_;
+        std::uint64_t start_cpu_sys_us_;
+        std::uint64_t start_vol_ctx_;
+        std::uint64_t start_invol_ctx_;
+        std::uint64_t last_cpu_us_;
+        std::map<int, ThreadSample> last_thread_samples_;
+
+        std::uint64_t samples_;
+        std::uint64_t saturated_samples_;
+        double max_cpu_percent_;
+        double max_thread_cpu_percent_;
+        std::uint64_t total_run_delay_us_;
+    };
+} // namespace qperf
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace qperf {
+    /**
+     * @brief Single writer sequence lock holding a snapshot of a trivially copyable value
+     * @details Store never blocks. Load retries while a store is in progress, so readers always see a
+     *          consistent snapshot. The value is kept as atomic words so concurrent access is not a data race.
+     */
+    template<typename T>
+    class SeqLock
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied by value");
+
+      public:
+        SeqLock()
+        {
+            for (auto& word : words_) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Publish a new snapshot, must only be called by one thread
+         */
+        void Store(const T& value) noexcept
+        {
+            std::uint64_t buffer[kWords] = {};
+            std::memcpy(buffer, &value, sizeof(T));
+
+            const auto sequence = sequence_.load(std::memory_order_relaxed);
+            sequence_.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words_[i].store(buffer[i], std::memory_order_relaxed);
+            }
+
+            sequence_.store(sequence + 2, std::memory_order_release);
+        }
+
+        T Load() const noexcept
+        {
+            std::uint64_t buffer[kWords];
+            std::uint64_t before;
+            std::uint64_t after;
+
+            do {
+                before = sequence_.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < kWords; ++i) {
+                    buffer[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = sequence_.load(std::memory_order_relaxed);
+            } while (before != after || (before & 1));
+
+            T value;
+            std::memcpy(&value, buffer, sizeof(T));
+            return value;
+        }
+
+      private:
+        static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+        std::atomic<std::uint64_t> sequence_{ 0 };
+        std::atomic<std::uint64_t> words_[kWords];
+    };
+} // namespace qperf
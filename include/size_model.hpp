@@ -0,0 +1,74 @@
+#pragma once
+
+#include "inicpp.h"
+#include "qperf.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qperf {
+    enum class SizeModel : uint8_t
+    {
+        kConstant,
+        kNormal,
+        kLogNormal,
+        kPareto,
+        kGop
+    };
+
+    /**
+     * @brief Object size model of a publish track
+     * @details The mean size of the first object of a group is first_object_size and of the other
+     *          objects object_size from the track config. The models vary sizes around those means.
+     */
+    struct SizeModelConfig
+    {
+        SizeModel model;
+        std::uint64_t seed;
+        double size_cv;                // normal: standard deviation as a fraction of the mean
+        double size_sigma;             // lognormal and gop: sigma of the underlying normal
+        double pareto_alpha;           // pareto: tail index, must be > 1 for a finite mean
+        std::string gop_pattern;       // gop: frame types after the I frame, e.g. PBB
+        double b_frame_ratio;          // gop: B frame mean size relative to object_size
+        double scene_cut_rate;         // gop: percent of frames that are scene cuts
+        double scene_cut_scale;        // gop: size multiplier of a scene cut frame
+        std::uint32_t max_object_size; // upper bound of any object, 0 is 8 times the larger configured size
+    };
+
+    /**
+     * @brief Object sizes of a track precomputed for the whole test
+     * @details Built once before the writer starts, so the publish loop only indexes an array.
+     *          An empty schedule means the constant model, the writer uses the configured sizes as is.
+     */
+    class SizeSchedule
+    {
+      public:
+        SizeSchedule() = default;
+
+        static SizeSchedule Build(const SizeModelConfig& size_config, const PerfConfig& perf_config);
+
+        bool Empty() const noexcept { return sizes_.empty(); }
+        std::size_t Length() const noexcept { return sizes_.size(); }
+        std::uint32_t MaxSize() const noexcept { return max_size_; }
+
+        /**
+         * @brief 99th percentile of the sizes, what the payload buffers are preallocated for
+         */
+        std::uint32_t TypicalSize() const noexcept { return typical_size_; }
+
+        /**
+         * @brief Size of the index'th object published, wraps if the test runs past the schedule
+         */
+        std::uint32_t Size(std::uint64_t index) const noexcept { return sizes_[index % sizes_.size()]; }
+
+      private:
+        std::vector<std::uint32_t> sizes_;
+        std::uint32_t max_size_{ 0 };
+        std::uint32_t typical_size_{ 0 };
+    };
+
+    bool PopulateSizeModel(const ini::IniSection& section, SizeModelConfig& config);
+
+    std::string SizeModelToString(SizeModel model);
+} // namespace qperf
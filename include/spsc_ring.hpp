@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace qperf {
+    /**
+     * @brief Bounded lock-free single producer, single consumer ring
+     * @details TryPush and TryPop never block or allocate. Each side caches the other side's index so
+     *          the shared cache line is only read when the cached value says the ring looks full/empty.
+     */
+    template<typename T>
+    class SpscRing
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "SpscRing elements are copied by value");
+
+      public:
+        explicit SpscRing(std::size_t capacity)
+          : mask_(RoundUpPowerOfTwo(capacity) - 1)
+          , slots_(new T[mask_ + 1])
+        {
+        }
+
+        bool TryPush(const T& value) noexcept
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            if (head - cached_tail_ > mask_) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head - cached_tail_ > mask_) {
+                    return false;
+                }
+            }
+
+            slots_[head & mask_] = value;
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPop(T& value) noexcept
+        {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            if (tail == cached_head_) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail == cached_head_) {
+                    return false;
+                }
+            }
+
+            value = slots_[tail & mask_];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::size_t Capacity() const noexcept { return mask_ + 1; }
+
+      private:
+        static std::size_t RoundUpPowerOfTwo(std::size_t value)
+        {
+            std::size_t result = 2;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        const std::size_t mask_;
+        std::unique_ptr<T[]> slots_;
+
+        // Producer side
+        alignas(64) std::atomic<std::uint64_t> head_{ 0 };
+        std::uint64_t cached_tail_{ 0 };
+
+        // Consumer side
+        alignas(64) std::atomic<std::uint64_t> tail_{ 0 };
+        std::uint64_t cached_head_{ 0 };
+    };
+} // namespace qperf
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "subscriber_track_handler.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qperf {
+    /**
+     * @brief Worker threads that compute subscriber statistics off the transport receive thread
+     * @details Handlers are assigned round robin to a fixed worker, so each handler's record queue keeps a
+     *          single consumer. Workers poll their handlers and back off briefly when all queues are empty.
+     */
+    class SubscriberAggregator
+    {
+      public:
+        explicit SubscriberAggregator(std::size_t num_threads);
+        ~SubscriberAggregator();
+
+        void Register(const std::shared_ptr<PerfSubscribeTrackHandler>& handler);
+
+        /**
+         * @brief Drain all queued records and stop the worker threads
+         */
+        void Stop();
+
+      private:
+        struct Worker
+        {
+            std::mutex handlers_mutex;
+            std::vector<std::shared_ptr<PerfSubscribeTrackHandler>> handlers;
+            std::thread thread;
+        };
+
+        void WorkerThread(Worker& worker);
+        static std::size_t Drain(Worker& worker);
+
+        std::atomic_bool terminate_;
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::atomic<std::size_t> next_worker_;
+    };
+} // namespace qperf
@@ -1,44 +1,169 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
 #include <quicr/client.h>
 
+#include "histogram.hpp"
 #include "inicpp.h"
+#include "integrity.hpp"
+#include "layer_schedule.hpp"
+#include "priority_tracker.hpp"
 #include "qperf.hpp"
+#include "spsc_ring.hpp"
+#include "sync_skew.hpp"
+#include "time_source.hpp"
+#include "trace.hpp"
 
 namespace qperf {
+    /**
+     * @brief Received object as handed from the transport thread to the aggregator
+     * @details Only the test header prefix of the payload is copied, the complete message is the largest.
+     */
+    struct ObjectRecord
+    {
+        std::uint64_t received_time;
+        std::uint64_t group_id;
+        std::uint64_t object_id;
+        std::uint64_t size;
+        IntegrityResult integrity;
+        bool priority_inverted;
+        std::uint32_t dropped_before; // records dropped by a full ring since the previous record was queued
+        ObjectTestComplete test;
+    };
+
     class PerfSubscribeTrackHandler : public quicr::SubscribeTrackHandler
     {
       private:
-        PerfSubscribeTrackHandler(const PerfConfig& perf_config, std::uint32_t test_identifier);
+        PerfSubscribeTrackHandler(const PerfConfig& perf_config,
+                                  std::uint32_t test_identifier,
+                                  const std::string& trace_prefix,
+                                  LayerSchedule layer_schedule);
 
       public:
+        static constexpr std::size_t kRecordQueueSize = 4096;
+        static constexpr std::size_t kAgeBuckets = 5;       // quarters of the TTL, the last one is past the TTL
+        static constexpr std::size_t kGroupWindow = 4;      // groups that may be in flight at the same time
+        static constexpr std::size_t kPositionBuckets = 3;  // object 0, 1-9 and 10+ of the group
+        static constexpr std::size_t kSpikeWindow = 8;      // objects before a spike it is attributed to
+        static constexpr std::size_t kMissingWindow = 1024; // latest gap objects a late arrival is credited for
+
         static std::shared_ptr<PerfSubscribeTrackHandler> Create(const std::string& section_name,
                                                                  ini::IniFile& inif,
-                                                                 std::uint32_t test_identifier);
+                                                                 std::uint32_t test_identifier,
+                                                                 const std::string& trace_prefix = "",
+                                                                 std::uint8_t relay_index = 0);
         void ObjectReceived(const quicr::ObjectHeaders&, quicr::BytesSpan) override;
         void StatusChanged(Status status) override;
         void MetricsSampled(const quicr::SubscribeTrackMetrics& metrics) override;
+
+        /**
+         * @brief Drain received objects queued by ObjectReceived and update the test statistics
+         * @details Must only be called from one thread at a time, normally a SubscriberAggregator worker.
+         * @returns number of objects processed
+         */
+        std::size_t ProcessRecords();
         const quicr::SubscribeTrackMetrics& GetMetrics() const noexcept { return metrics_; }
 
         bool IsComplete() { return terminate_; }
 
         std::string TestName() { return perf_config_.test_name; }
+        std::chrono::milliseconds JoinDelay() const noexcept
+        {
+            return std::chrono::milliseconds(perf_config_.join_delay);
+        }
+
+        /**
+         * @brief Mark the time the subscribe is sent, join times are measured from it
+         */
+        void Joining() { join_time_ = TimeSource::Instance().EpochNowUs(); }
+        bool Joined() const noexcept { return join_time_ != 0; }
+
+        /**
+         * @brief Mark the track resubscribed after a connection outage
+         * @details The first object received after this measures the time to media restored and the
+         *          objects lost across the outage.
+         * @param outage_start_us   Epoch time the connection was lost
+         */
+        void Resubscribing(std::uint64_t outage_start_us);
+
+        /**
+         * @brief Measure the A/V sync skew of this track against the other tracks of the same publisher
+         * @details Must be set before the subscribe is sent.
+         */
+        void SetSyncSkew(std::shared_ptr<SyncSkewTracker> sync_skew)
+        {
+            sync_track_ = sync_skew->AddTrack(perf_config_.test_name);
+            sync_skew_ = std::move(sync_skew);
+        }
+        std::uint64_t TotalObjects() const noexcept { return total_objects_.load(std::memory_order_relaxed); }
 
       private:
+        /**
+         * @brief Objects received of a group, the group completes when all its objects have arrived
+         */
+        struct GroupProgress
+        {
+            std::uint64_t group_id{ 0 };
+            std::uint64_t first_publish_time{ 0 };
+            std::uint64_t last_arrival_time{ 0 };
+            std::uint64_t objects{ 0 };
+            bool complete{ false };
+        };
+
+        /**
+         * @brief Latency and loss of one layer of a layered track
+         * @details Loss is tracked on the layer's own object sequence, so head-of-line blocking or drops of
+         *          one subgroup show up on its layer only.
+         */
+        struct LayerStats
+        {
+            Histogram latency;
+            std::uint64_t objects{ 0 };
+            std::uint64_t lost_objects{ 0 };
+            std::uint64_t reordered_objects{ 0 };
+            std::uint64_t expected_group_id{ 0 };
+            std::uint64_t expected_index{ 0 };
+        };
+
+        void ProcessRecord(const ObjectRecord& record);
+        void TrackLoss(const ObjectRecord& record);
+        void RememberMissing(const ObjectRecord& record);
+        void TrackJoin(const ObjectRecord& record);
+        void TrackRestore(const ObjectRecord& record, std::uint64_t resubscribe_time);
+        void TrackStale(const ObjectRecord& record, std::uint64_t lost_objects);
+        void TrackLayer(const ObjectRecord& record);
+        void TrackGroup(const ObjectRecord& record);
+        void TrackPosition(const ObjectRecord& record);
+        void ReportPositions();
+        void CompleteGroup(GroupProgress& group, std::uint64_t group_objects);
+        void FinishGroup(const GroupProgress& group);
+        void ReportLayers();
+
         std::atomic_bool terminate_;
         PerfConfig perf_config_;
+        LayerSchedule layer_schedule_;
+        std::uint64_t objects_per_group_;
+        std::vector<LayerStats> layer_stats_;
         quicr::SubscribeTrackMetrics metrics_;
         bool first_pass_;
-        std::chrono::time_point<std::chrono::system_clock> last_metric_time_;
+        std::chrono::steady_clock::time_point last_metric_time_;
         uint64_t last_bytes_;
         std::uint64_t local_now_;
         std::uint64_t last_local_now_;
         std::uint64_t start_data_time_;
-        std::uint64_t total_objects_;
+        std::atomic<std::uint64_t> total_objects_; // read by the client thread through TotalObjects
         std::uint64_t total_bytes_;
         std::uint32_t test_identifier_;
-        qperf::TestMode test_mode_;
+        std::atomic<qperf::TestMode> test_mode_;
+
+        // Guards the bitrate fields, updated by MetricsSampled and reported by the aggregator
+        std::mutex metrics_mutex_;
 
         std::uint64_t max_bitrate_;
         std::uint64_t min_bitrate_;
@@ -56,6 +181,76 @@ namespace qperf {
         std::int64_t min_object_arrival_delta_;
         double avg_object_arrival_delta_;
         std::int64_t total_arrival_delta_;
+
+        SpscRing<ObjectRecord> records_;
+        std::atomic<std::uint64_t> records_dropped_;
+        std::uint32_t pending_dropped_; // only touched by the transport receive thread
+        Histogram transmit_latency_;
+
+        std::uint64_t expected_group_id_;
+        std::uint64_t expected_object_id_;
+
+        // Objects counted as lost, a late arrival of one of them is reordered instead of lost
+        std::set<std::pair<std::uint64_t, std::uint64_t>> missing_objects_;
+        std::uint64_t lost_objects_;
+        std::uint64_t reordered_objects_;
+        std::uint64_t priority_inversions_;
+
+        // Object age against the TTL carried in the test header
+        std::array<std::uint64_t, kAgeBuckets> age_buckets_;
+        std::uint64_t stale_objects_;
+        std::uint64_t stale_bytes_;
+        std::uint64_t ttl_lost_objects_;
+        std::uint64_t last_publish_time_;
+
+        std::uint64_t integrity_checked_;
+        std::uint64_t integrity_corrupt_;
+        std::uint64_t integrity_size_mismatch_;
+
+        // Late join, measured from the subscribe. Objects published before it were served from the relay cache
+        std::atomic<std::uint64_t> join_time_;
+        std::uint64_t first_object_time_;
+        std::uint64_t first_group_start_time_;
+        std::uint64_t catchup_objects_;
+        std::uint64_t catchup_bytes_;
+        std::uint64_t catchup_first_time_;
+        std::uint64_t catchup_last_time_;
+
+        // Connection outages, the outage start is published by the resubscribe time
+        std::uint64_t outage_start_time_;
+        std::atomic<std::uint64_t> resubscribe_time_;
+        std::uint64_t outages_;
+        std::uint64_t outage_lost_objects_;
+        std::uint64_t max_restore_time_;
+
+        // Group completion, from the publish time of the first object to the arrival of the group's last object
+        std::array<GroupProgress, kGroupWindow> groups_;
+        std::optional<std::uint64_t> first_group_id_;
+        Histogram group_latency_;
+        std::uint64_t incomplete_groups_;
+
+        // Latency by object position in the group, and the bytes received just before latency spikes.
+        // A spike is above the p99 latency of the track so far, refreshed periodically.
+        std::array<Histogram, kPositionBuckets> position_latency_;
+        std::array<std::uint64_t, kSpikeWindow> recent_sizes_;
+        std::uint64_t recent_bytes_;
+        std::uint64_t position_objects_;
+        std::uint64_t total_recent_bytes_;
+        std::uint64_t spike_threshold_;
+        std::uint64_t spikes_;
+        std::uint64_t burst_spikes_;
+        std::uint64_t spike_recent_bytes_;
+
+        // Tracks of the same remote publisher, for the A/V sync skew
+        std::shared_ptr<SyncSkewTracker> sync_skew_;
+        std::size_t sync_track_;
+
+        // Relay of the track's publisher, from the test header
+        std::uint8_t publisher_relay_index_;
+
+        // Received object trace, written by the aggregator when trace_path_ is set
+        std::string trace_path_;
+        TraceWriter trace_writer_;
     };
 
 } // namespace
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "histogram.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qperf {
+    /**
+     * @brief A/V synchronization skew between the tracks of one remote participant
+     * @details The subscribe tracks of a participant record the publish time and delivery latency of
+     *          their objects. Each object of a non reference track is paired with the object of the
+     *          reference track (the first track added, normally audio) closest to it in publish time,
+     *          if within kSameTimeUs. The reference objects of the last kSkewWindowUs are kept, and an
+     *          object waits until the reference track has delivered past its publish time, so pairs form
+     *          whichever of the two arrives first. The skew is the difference of the delivery latencies,
+     *          so the clock offset to the publisher cancels out. Called from the aggregator threads.
+     */
+    class SyncSkewTracker
+    {
+      public:
+        // Objects published this close together are presented together, about a video frame apart at most
+        static constexpr std::uint64_t kSameTimeUs = 10'000;
+
+        // Largest skew measured, objects further apart in delivery than this are not paired
+        static constexpr std::uint64_t kSkewWindowUs = 2'000'000;
+
+        explicit SyncSkewTracker(std::uint32_t participant_id);
+
+        /**
+         * @brief Add a track of the participant
+         * @returns index of the track to record its objects with
+         */
+        std::size_t AddTrack(const std::string& track_name);
+
+        void Record(std::size_t track, std::uint64_t publish_time, std::int64_t latency);
+
+        void Report(const std::string& endpoint_id);
+
+      private:
+        struct SkewEntry
+        {
+            std::uint64_t publish_time;
+            std::int64_t latency;
+        };
+
+        struct TrackSkew
+        {
+            std::string name;
+
+            // Reference track: objects of the last kSkewWindowUs. Other tracks: objects waiting to be paired
+            std::deque<SkewEntry> recent;
+
+            // Skew against the reference track, split by which of the two was delivered later
+            Histogram later;
+            Histogram earlier;
+            std::int64_t total_skew{ 0 };
+        };
+
+        /**
+         * @brief Pair the waiting objects of a track that are ready
+         * @param flush     Pair all waiting objects, at the end of the test
+         */
+        void PairWaiting(TrackSkew& track, bool flush);
+        void Pair(TrackSkew& track, const SkewEntry& entry);
+
+        std::uint32_t participant_id_;
+        std::mutex mutex_;
+        std::vector<TrackSkew> tracks_;
+        std::uint64_t newest_publish_time_{ 0 };
+        std::uint64_t newest_reference_time_{ 0 };
+    };
+} // namespace qperf
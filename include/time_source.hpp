@@ -0,0 +1,102 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+
+namespace qperf {
+    /**
+     * @brief Cheap monotonic timestamps mapped to the wall clock epoch
+     * @details Hot paths read a raw monotonic clock (CLOCK_MONOTONIC_RAW on Linux, steady_clock elsewhere).
+     *          The offset to the wall clock epoch is calibrated once per process, so the times put on the
+     *          wire and in reports stay comparable across hosts while NTP slews and steps during a test
+     *          do not corrupt the deltas. Steps are detected by comparing the wall clock to the mapping.
+     */
+    class TimeSource
+    {
+      public:
+        // NTP only steps the clock for offsets above 128 ms, slews stay well below this between checks
+        static constexpr std::int64_t kClockStepThresholdUs = 5'000;
+
+        static TimeSource& Instance()
+        {
+            static TimeSource instance;
+            return instance;
+        }
+
+        static std::uint64_t MonotonicNowUs() noexcept
+        {
+#if defined(__linux__)
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+            return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000 + static_cast<std::uint64_t>(ts.tv_nsec) / 1000;
+#else
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+              .count();
+#endif
+        }
+
+        std::uint64_t ToEpochUs(std::uint64_t monotonic_us) const noexcept { return monotonic_us + epoch_offset_us_; }
+
+        std::uint64_t EpochNowUs() const noexcept { return ToEpochUs(MonotonicNowUs()); }
+
+        /**
+         * @brief Compare the wall clock with the mapped epoch to detect clock steps
+         * @details Not for the hot path, call from periodic callbacks such as MetricsSampled
+         * @returns true if the wall clock stepped since the last check
+         */
+        bool CheckClockStep()
+        {
+            const auto drift = WallClockUs() - static_cast<std::int64_t>(EpochNowUs());
+            const auto last_drift = last_drift_us_.exchange(drift);
+
+            if (std::llabs(drift - last_drift) < kClockStepThresholdUs) {
+                return false;
+            }
+
+            clock_steps_ += 1;
+            SPDLOG_WARN("Wall clock stepped by {} us, drift from monotonic mapping is now {} us",
+                        drift - last_drift,
+                        drift);
+            return true;
+        }
+
+        std::uint64_t ClockSteps() const noexcept { return clock_steps_; }
+
+      private:
+        TimeSource()
+          : epoch_offset_us_(0)
+          , last_drift_us_(0)
+          , clock_steps_(0)
+        {
+            // Keep the wall clock read that was bracketed most tightly by the monotonic reads
+            std::uint64_t best_window = UINT64_MAX;
+            for (int i = 0; i < 16; ++i) {
+                const auto before = MonotonicNowUs();
+                const auto wall = WallClockUs();
+                const auto after = MonotonicNowUs();
+
+                if (after - before < best_window) {
+                    best_window = after - before;
+                    epoch_offset_us_ = static_cast<std::uint64_t>(wall) - (before + after) / 2;
+                }
+            }
+        }
+
+        static std::int64_t WallClockUs() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+              .count();
+        }
+
+        std::uint64_t epoch_offset_us_;
+        std::atomic<std::int64_t> last_drift_us_;
+        std::atomic<std::uint64_t> clock_steps_;
+    };
+} // namespace qperf
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace qperf {
+    /**
+     * @brief Header at the start of a qperf trace file
+     * @details All fields are little endian. Offsets of the records are relative to epoch_base_us,
+     *          the wall clock epoch time in microseconds of the first record.
+     */
+    struct TraceFileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t header_size;
+        std::uint64_t epoch_base_us;
+        char track_name[64];
+    };
+    static_assert(sizeof(TraceFileHeader) == 88, "trace header layout is part of the file format");
+
+    /**
+     * @brief One object in a trace file
+     */
+    struct TraceRecord
+    {
+        std::uint64_t offset_us; // time since the first record
+        std::uint64_t group_id;
+        std::uint64_t object_id;
+        std::uint32_t size;
+        std::uint32_t flags; // reserved, zero
+    };
+    static_assert(sizeof(TraceRecord) == 32, "trace record layout is part of the file format");
+
+    constexpr char kTraceMagic[8] = { 'Q', 'P', 'T', 'R', 'A', 'C', 'E', '1' };
+    constexpr std::uint32_t kTraceVersion = 1;
+
+    /**
+     * @brief Reads a trace file through a read-only memory mapping
+     * @details Records are read in order. Pages behind the cursor are released as the reader moves on,
+     *          so a multi-hour trace is streamed from the page cache instead of being held in memory.
+     */
+    class TraceReader
+    {
+      public:
+        TraceReader() = default;
+        ~TraceReader();
+
+        TraceReader(const TraceReader&) = delete;
+        TraceReader& operator=(const TraceReader&) = delete;
+
+        bool Open(const std::string& path);
+
+        /**
+         * @brief Read the next record
+         * @returns false at the end of the trace
+         */
+        bool Next(TraceRecord& record);
+
+        const TraceFileHeader& Header() const noexcept { return header_; }
+        std::uint64_t Count() const noexcept { return count_; }
+
+      private:
+        void ReleaseConsumed();
+
+        TraceFileHeader header_{};
+        const std::uint8_t* data_{ nullptr };
+        std::size_t size_{ 0 };
+        std::uint64_t count_{ 0 };
+        std::uint64_t next_{ 0 };
+        std::size_t released_{ 0 };
+    };
+
+    /**
+     * @brief Writes a trace file through a large stdio buffer
+     */
+    class TraceWriter
+    {
+      public:
+        TraceWriter() = default;
+        ~TraceWriter();
+
+        TraceWriter(const TraceWriter&) = delete;
+        TraceWriter& operator=(const TraceWriter&) = delete;
+
+        bool Open(const std::string& path, const std::string& track_name, std::uint64_t epoch_base_us);
+        void Write(const TraceRecord& record);
+        void Close();
+
+        bool IsOpen() const noexcept { return file_ != nullptr; }
+        std::uint64_t EpochBase() const noexcept { return epoch_base_us_; }
+        std::uint64_t Count() const noexcept { return count_; }
+
+      private:
+        std::FILE* file_{ nullptr };
+        std::uint64_t epoch_base_us_{ 0 };
+        std::uint64_t count_{ 0 };
+    };
+} // namespace qperf
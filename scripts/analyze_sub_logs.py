@@ -11,6 +11,8 @@ import click
 import time
 import traceback
 import os
+import re
+import struct
 
 logging.basicConfig(format='%(asctime)s | %(levelname)-8s | %(name)s[%(lineno)s] %(threadName)s | %(message)s',
                     level=logging.INFO)
@@ -18,6 +20,233 @@ LOG = logging.getLogger("analyze_sub_logs")
 
 PATH = "./"
 
+# Skew users notice when audio leads video, the stricter side of ITU-R BT.1359
+SYNC_THRESHOLD_US = 45000
+
+# qperf trace file layout, see include/trace.hpp
+TRACE_HEADER = struct.Struct("<8sIIQ64s")
+TRACE_RECORD = struct.Struct("<QQQII")
+TRACE_MAGIC = b"QPTRACE1"
+TRACE_VERSION = 1
+TRACE_CHUNK_RECORDS = 65536
+
+# Subscribers listed by how often they were last, and the multiple of the fair 1/n share that is flagged
+FANOUT_TOP_SUBSCRIBERS = 10
+FANOUT_LAST_FACTOR = 2
+
+
+def process_netem_logs_path(path):
+    """
+    Report the impairment applied by qperf_netem when its log is in the same directory as the
+    subscriber logs, so the results are read together with the network conditions.
+    """
+    found = False
+    for filename in sorted(os.listdir(path)):
+        if not (filename.startswith("netem") and filename.endswith(".txt")):
+            continue
+
+        with open(os.path.join(path, filename), "r") as f:
+            for line in f.readlines():
+                if "NETEM phase " in line:
+                    LOG.info(f"IMPAIRMENT: {line.split('NETEM phase ', maxsplit=1)[1].strip()}")
+                elif "NETEM COMPLETE, " in line:
+                    found = True
+                    csv = line.split("NETEM COMPLETE, ", maxsplit=1)[1].strip().split(", ")
+                    if len(csv) >= 11:
+                        LOG.info(f"IMPAIRMENT: {csv[0]} packets: {csv[2]} dropped loss: {csv[4]} dropped queue: {csv[5]}"
+                                 f" reordered: {csv[6]} avg delay us: {csv[8]} max delay us: {csv[9]}")
+
+    if not found:
+        LOG.info("IMPAIRMENT: none recorded")
+
+
+def percentile(values, pct):
+    if not values:
+        return 0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(pct / 100.0 * len(values)))]
+
+
+def process_fetch_logs_path(path):
+    """
+    Report the qperf_fetch results when fetch client logs are in the directory. Completion times are
+    in milliseconds since the fetch was sent.
+    """
+    completion_ms = []
+    bitrates = []
+    num_fetches = 0
+    num_timed_out = 0
+    total_bytes = 0
+
+    for filename in sorted(os.listdir(path)):
+        if not (filename.startswith("f_") and filename.endswith("logs.txt")):
+            continue
+
+        with open(os.path.join(path, filename), "r") as f:
+            for line in f.readlines():
+                if "FETCH COMPLETE, " not in line:
+                    continue
+
+                csv = line.split("FETCH COMPLETE, ", maxsplit=1)[1].strip().split(", ")
+                if len(csv) < 13:
+                    LOG.info(f"Skipping line csv length: {len(csv)}, expected 13")
+                    continue
+
+                num_fetches += 1
+                total_bytes += int(csv[7])
+                if int(csv[12]) != 0 or int(csv[9]) < 0:
+                    num_timed_out += 1
+                    LOG.info(f"file: {filename} track name: '{csv[1]}' fetch {csv[2]} incomplete,"
+                             f" {csv[5]} of {csv[6]} objects")
+                    continue
+
+                completion_ms.append(int(csv[9]) / 1000.0)
+                bitrates.append(int(csv[10]))
+
+    if num_fetches == 0:
+        return
+
+    LOG.info(f"FETCH: {num_fetches} fetches, {num_timed_out} incomplete, {total_bytes} bytes")
+    if completion_ms:
+        LOG.info(f"FETCH: completion ms p50: {percentile(completion_ms, 50):.1f}"
+                 f" p90: {percentile(completion_ms, 90):.1f} max: {max(completion_ms):.1f}")
+        LOG.info(f"FETCH: bitrate per fetch p50: {percentile(bitrates, 50)} min: {min(bitrates)}")
+    if num_timed_out:
+        LOG.warning(f"ANALYSIS: {num_timed_out} fetches did not complete")
+
+
+def trace_subscriber(filename, track_name):
+    """
+    Name of the subscriber that wrote a trace, the file name without the track suffix. The subscriber
+    writes <prefix>_<id>_<test name>.qtrace with a track name of <id>:<test name>.
+    """
+    track_id, _, test_name = track_name.partition(":")
+    suffix = f"_{track_id}_{re.sub('[^A-Za-z0-9]', '_', test_name)}.qtrace"
+    if filename.endswith(suffix):
+        return filename[:-len(suffix)]
+    return filename[:-len(".qtrace")]
+
+
+def read_trace(path):
+    """
+    Yield (track name, arrival time us, group id, object id) of the records of a trace file, streamed
+    in chunks so traces of any length are read in constant memory.
+    """
+    with open(path, "rb") as f:
+        header = f.read(TRACE_HEADER.size)
+        if len(header) < TRACE_HEADER.size:
+            LOG.info(f"Skipping trace {path}, too short")
+            return
+
+        magic, version, header_size, epoch_base_us, track_name = TRACE_HEADER.unpack(header)
+        if magic != TRACE_MAGIC or version != TRACE_VERSION or header_size < TRACE_HEADER.size:
+            LOG.info(f"Skipping {path}, not a version {TRACE_VERSION} qperf trace")
+            return
+
+        track_name = track_name.split(b"\0", maxsplit=1)[0].decode(errors="replace")
+        f.seek(header_size)
+        while True:
+            chunk = f.read(TRACE_RECORD.size * TRACE_CHUNK_RECORDS)
+            chunk = chunk[:len(chunk) - len(chunk) % TRACE_RECORD.size]
+            if not chunk:
+                break
+            for offset_us, group_id, object_id, _, _ in TRACE_RECORD.iter_unpack(chunk):
+                yield track_name, epoch_base_us + offset_us, group_id, object_id
+
+
+def jain_index(values):
+    """
+    Jain's fairness index, 1.0 when all values are equal down to 1/n when one value has it all
+    """
+    total = sum(values)
+    squares = sum(v * v for v in values)
+    if not values or squares == 0:
+        return 1.0
+    return total * total / (len(values) * squares)
+
+
+def process_fanout_traces_path(path):
+    """
+    Report the fan-out skew of the relay: the spread of arrival times of the same object across the
+    subscribers that recorded it with --trace_dir. Objects are joined on (track, group, object) across
+    all traces in the directory. The first pass keeps the first and last arrival of each object, the
+    second pass charges each subscriber with how far behind the first arrival it received each object,
+    so memory is bounded by the objects and the subscribers, not their product. Arrival times are
+    compared across clients, they should run on one host or hosts with synchronized clocks.
+    """
+    traces = sorted(os.path.join(path, filename) for filename in os.listdir(path) if filename.endswith(".qtrace"))
+    if not traces:
+        LOG.info(f"FANOUT: no traces found in {path}")
+        return
+
+    # (track, group, object) -> [first arrival, last arrival, subscribers]
+    objects = {}
+    for trace in traces:
+        for track_name, arrival, group_id, object_id in read_trace(trace):
+            times = objects.get((track_name, group_id, object_id))
+            if times is None:
+                objects[(track_name, group_id, object_id)] = [arrival, arrival, 1]
+            else:
+                times[0] = min(times[0], arrival)
+                times[1] = max(times[1], arrival)
+                times[2] += 1
+
+    shared = {key: times for key, times in objects.items() if times[2] > 1}
+    if not shared:
+        LOG.info(f"FANOUT: {len(traces)} traces, no object was received by more than one subscriber")
+        return
+
+    # subscriber -> [objects, total lateness us, max lateness us, times last]
+    subscribers = {}
+    for trace in traces:
+        stats = None
+        for track_name, arrival, group_id, object_id in read_trace(trace):
+            if stats is None:
+                stats = subscribers.setdefault(trace_subscriber(os.path.basename(trace), track_name), [0, 0, 0, 0])
+
+            times = shared.get((track_name, group_id, object_id))
+            if times is None:
+                continue
+            lateness = arrival - times[0]
+            stats[0] += 1
+            stats[1] += lateness
+            stats[2] = max(stats[2], lateness)
+            if arrival == times[1] and times[1] > times[0]:
+                stats[3] += 1
+
+    spreads = [times[1] - times[0] for times in shared.values()]
+    LOG.info(f"FANOUT: {len(subscribers)} subscribers, {len(shared)} objects received by more than one,"
+             f" spread us p50: {percentile(spreads, 50)} p90: {percentile(spreads, 90)}"
+             f" p99: {percentile(spreads, 99)} max: {max(spreads)}")
+
+    tracks = {}
+    for (track_name, _, _), times in shared.items():
+        tracks.setdefault(track_name, []).append(times[1] - times[0])
+    for track_name, track_spreads in sorted(tracks.items()):
+        LOG.info(f"FANOUT: '{track_name}' {len(track_spreads)} objects, spread us p50: {percentile(track_spreads, 50)}"
+                 f" p99: {percentile(track_spreads, 99)} max: {max(track_spreads)}")
+
+    mean_lateness = {name: stats[1] / stats[0] for name, stats in subscribers.items() if stats[0]}
+    last_counts = {name: stats[3] for name, stats in subscribers.items() if stats[0]}
+    LOG.info(f"FANOUT: fairness index lateness: {jain_index(list(mean_lateness.values())):.3f}"
+             f" last: {jain_index(list(last_counts.values())):.3f}")
+
+    # An even fan-out order makes each subscriber last for about 1/n of the objects it receives
+    num_always_last = 0
+    for name in sorted(mean_lateness, key=lambda n: last_counts[n], reverse=True)[:FANOUT_TOP_SUBSCRIBERS]:
+        received, _, max_lateness, last = subscribers[name]
+        if last == 0:
+            break
+        share = last / received
+        LOG.info(f"FANOUT: subscriber {name} last for {last} of {received} objects ({share:.1%}),"
+                 f" lateness us mean: {mean_lateness[name]:.0f} max: {max_lateness}")
+        if share > FANOUT_LAST_FACTOR / len(mean_lateness):
+            num_always_last += 1
+
+    if num_always_last:
+        LOG.warning(f"ANALYSIS: {num_always_last} subscribers were last more than {FANOUT_LAST_FACTOR} times"
+                    f" their fair share, the relay fan-out order favors some subscribers")
+
 
 def process_sub_logs_path(path):
     directory = os.fsencode(path)
@@ -25,6 +254,27 @@ def process_sub_logs_path(path):
     num_delayed = 0
     num_lost_objects = 0
     num_not_completed = 0
+    num_saturated = 0
+    num_log_drops = 0
+    num_record_drops = 0
+    num_corrupt_tracks = 0
+    p99_latencies = []
+    restore_ms = []
+    num_outage_lost_objects = 0
+    relay_pairs = {}
+    priorities = {}
+    layers = {}
+    group_p99_latencies = []
+    position_p99_latencies = [[], [], []]
+    num_spikes = 0
+    sync_p99_skews = []
+    num_out_of_sync = 0
+    num_burst_spikes = 0
+    num_incomplete_group_tracks = 0
+    num_stale_tracks = 0
+    num_stale_objects = 0
+    num_ttl_lost_objects = 0
+    num_transport_lost_objects = 0
 
     for file in os.listdir(directory):
         filename = os.fsdecode(file)
@@ -36,7 +286,105 @@ def process_sub_logs_path(path):
             complete = False
             with open(file, "r") as f:
                 for line in f.readlines():
-                    if "OR COMPLETE, " in line:
+                    if "LOG COMPLETE, " in line:
+                        dropped = int(line.split("LOG COMPLETE, ", maxsplit=1)[1].strip().split(", ")[-1])
+                        if dropped > 0:
+                            num_log_drops += 1
+                            LOG.info(f"file: {filename} dropped {dropped} log lines")
+                    elif "PROFILE COMPLETE, " in line:
+                        csv = line.split("PROFILE COMPLETE, ", maxsplit=1)[1].strip().split(", ")
+                        if csv[-1] == "INVALID":
+                            num_saturated += 1
+                            LOG.info(f"file: {filename} client saturated, results are INVALID"
+                                     f" max cpu: {csv[4]} max thread cpu: {csv[5]} late wakeups: {csv[13]}")
+                    elif "OR LOSS, " in line:
+                        csv = line.split("OR LOSS, ", maxsplit=1)[1].strip().split(", ")
+                        if int(csv[4]) > 0:
+                            num_record_drops += 1
+                            LOG.info(f"id: {csv[0]} track name: '{csv[1]}' statistics dropped {csv[4]} records"
+                                     f" lost: {csv[2]} reordered: {csv[3]}")
+                    elif "OR INTEGRITY, " in line:
+                        csv = line.split("OR INTEGRITY, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 5 and (int(csv[3]) > 0 or int(csv[4]) > 0):
+                            num_corrupt_tracks += 1
+                            LOG.info(f"id: {csv[0]} track name: '{csv[1]}' {csv[3]} corrupt and {csv[4]} size"
+                                     f" mismatched of {csv[2]} checked objects")
+                    elif "OR RESTORED, " in line:
+                        csv = line.split("OR RESTORED, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 6:
+                            restore_ms.append(int(csv[3]) / 1000.0)
+                            num_outage_lost_objects += int(csv[5])
+                    elif "OR TTL, " in line:
+                        csv = line.split("OR TTL, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 12:
+                            stale = int(csv[3])
+                            if stale > 0:
+                                num_stale_tracks += 1
+                                LOG.info(f"id: {csv[0]} track name: '{csv[1]}' {stale} objects delivered past"
+                                         f" the {csv[2]} ms TTL, {csv[4]} bytes")
+                            num_stale_objects += stale
+                            num_ttl_lost_objects += int(csv[10])
+                            num_transport_lost_objects += int(csv[11])
+                    elif "OR SYNC, " in line:
+                        csv = line.split("OR SYNC, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 11 and int(csv[4]) > 0:
+                            p99_skew = int(csv[9])
+                            sync_p99_skews.append(p99_skew)
+                            if p99_skew > SYNC_THRESHOLD_US:
+                                num_out_of_sync += 1
+                                LOG.info(f"endpoint: {csv[0]} participant: {csv[1]} '{csv[3]}' to '{csv[2]}' skew us"
+                                         f" mean: {csv[7]} p99: {p99_skew} max: {csv[10]}")
+                    elif "OR POSITION, " in line:
+                        csv = line.split("OR POSITION, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 14:
+                            for bucket in range(3):
+                                if int(csv[2 + bucket * 4]) > 0:
+                                    position_p99_latencies[bucket].append(int(csv[4 + bucket * 4]))
+                    elif "OR SPIKE, " in line:
+                        csv = line.split("OR SPIKE, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 8:
+                            num_spikes += int(csv[3])
+                            num_burst_spikes += int(csv[4])
+                    elif "OR GROUP, " in line:
+                        csv = line.split("OR GROUP, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 8:
+                            if int(csv[2]) > 0:
+                                group_p99_latencies.append(int(csv[6]))
+                            if int(csv[3]) > 0:
+                                num_incomplete_group_tracks += 1
+                                LOG.info(f"id: {csv[0]} track name: '{csv[1]}' {csv[3]} incomplete groups"
+                                         f" of {int(csv[2]) + int(csv[3])}")
+                    elif "OR LAYER, " in line:
+                        csv = line.split("OR LAYER, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 10:
+                            layer = layers.setdefault((csv[1], int(csv[2])), [int(csv[3]), 0, 0, [], []])
+                            layer[1] += int(csv[4])
+                            layer[2] += int(csv[5])
+                            layer[3].append(int(csv[7]))
+                            layer[4].append(int(csv[8]))
+                    elif "OR PRIORITY, " in line:
+                        csv = line.split("OR PRIORITY, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 9:
+                            level = priorities.setdefault(int(csv[2]), [0, 0, 0, 0, [], []])
+                            level[0] += 1
+                            level[1] += int(csv[3])
+                            level[2] += int(csv[4])
+                            level[3] += int(csv[5])
+                            level[4].append(int(csv[6]))
+                            level[5].append(int(csv[7]))
+                    elif "OR RELAY, " in line:
+                        csv = line.split("OR RELAY, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 8:
+                            pair = relay_pairs.setdefault((int(csv[2]), int(csv[3])), [0, 0, [], []])
+                            pair[0] += 1
+                            pair[1] += int(csv[5])
+                            pair[2].append(int(csv[6]))
+                            pair[3].append(int(csv[7]))
+                    elif "OR LATENCY, " in line:
+                        csv = line.split("OR LATENCY, ", maxsplit=1)[1].strip().split(", ")
+                        if len(csv) >= 7:
+                            p99_latencies.append(int(csv[4]))
+                    elif "OR COMPLETE, " in line:
                         complete = True
                         csv = line.split("OR COMPLETE, ", maxsplit=1)[1].split(", ")
 
@@ -64,14 +412,86 @@ def process_sub_logs_path(path):
             continue
     # End of for loop through all files
 
+    if restore_ms:
+        LOG.info(f"OUTAGE: {len(restore_ms)} track restores, time to media restored ms"
+                 f" p50: {percentile(restore_ms, 50):.1f} max: {max(restore_ms):.1f},"
+                 f" {num_outage_lost_objects} objects lost across outages")
+
+    for (pub_relay, sub_relay), (tracks, lost, p50s, p99s) in sorted(relay_pairs.items()):
+        LOG.info(f"RELAY: {pub_relay} -> {sub_relay}, {tracks} tracks, {lost} objects lost, latency us"
+                 f" p50 median: {percentile(p50s, 50)} p99 max: {max(p99s)}")
+
+    if num_ttl_lost_objects or num_transport_lost_objects:
+        LOG.info(f"TTL: {num_stale_objects} stale objects delivered, lost objects {num_ttl_lost_objects} TTL expired"
+                 f" {num_transport_lost_objects} transport")
+
+    if sync_p99_skews:
+        LOG.info(f"SYNC: {len(sync_p99_skews)} participant tracks, p99 A/V skew us median:"
+                 f" {percentile(sync_p99_skews, 50)} max: {max(sync_p99_skews)}")
+
+    if position_p99_latencies[0]:
+        LOG.info("POSITION: p99 latency us median by object position, "
+                 + ", ".join(f"{name}: {percentile(values, 50)}" for name, values in
+                             zip(["object 0", "objects 1-9", "objects 10+"], position_p99_latencies) if values))
+    if num_spikes:
+        LOG.info(f"SPIKE: {num_spikes} latency spikes, {num_burst_spikes} after a size burst,"
+                 f" {num_spikes - num_burst_spikes} elsewhere")
+
+    if group_p99_latencies:
+        LOG.info(f"GROUP: {len(group_p99_latencies)} tracks, p99 group completion latency us median:"
+                 f" {percentile(group_p99_latencies, 50)} max: {max(group_p99_latencies)}")
+
+    for (track, layer), (priority, objects, lost, p50s, p99s) in sorted(layers.items()):
+        LOG.info(f"LAYER: '{track}' layer {layer} priority {priority}, {objects} objects, {lost} lost, latency us"
+                 f" p50 median: {percentile(p50s, 50)} p99 median: {percentile(p99s, 50)} p99 max: {max(p99s)}")
+
+    # Lower value is higher priority, each level should see no more latency than the levels below it
+    num_priority_inversions = 0
+    num_priority_latency_inversions = 0
+    higher_p99 = None
+    for priority, (tracks, objects, lost, inversions, p50s, p99s) in sorted(priorities.items()):
+        p99 = percentile(p99s, 50)
+        LOG.info(f"PRIORITY: {priority}, {tracks} tracks, {objects} objects, {lost} lost, {inversions} inversions,"
+                 f" latency us p50 median: {percentile(p50s, 50)} p99 median: {p99} p99 max: {max(p99s)}")
+        num_priority_inversions += inversions
+        if higher_p99 is not None and p99 < higher_p99[1]:
+            num_priority_latency_inversions += 1
+            LOG.warning(f"ANALYSIS: priority {higher_p99[0]} p99 latency {higher_p99[1]} us is above lower"
+                        f" priority {priority} p99 latency {p99} us")
+        higher_p99 = (priority, p99)
+
+    if p99_latencies:
+        LOG.info(f"LIVE: {len(p99_latencies)} tracks, p99 transmit latency us median: {percentile(p99_latencies, 50)}"
+                 f" max: {max(p99_latencies)}")
+
     if num_delayed > 0:
         LOG.warning(f"ANALYSIS: {num_delayed} subscriber tracks were delayed 2 or more times the expected interval")
     if num_lost_objects:
         LOG.warning(f"ANALYSIS: {num_lost_objects} subscriber tracks had lost objects")
     if num_not_completed:
         LOG.warning(f"ANALYSIS: {num_not_completed} subscribers did not complete")
+    if num_saturated:
+        LOG.warning(f"ANALYSIS: {num_saturated} clients were saturated, their results are invalid")
+    if num_log_drops:
+        LOG.warning(f"ANALYSIS: {num_log_drops} clients dropped log lines, their logs are incomplete")
+    if num_out_of_sync:
+        LOG.warning(f"ANALYSIS: {num_out_of_sync} participant tracks had a p99 A/V skew above"
+                    f" {SYNC_THRESHOLD_US // 1000} ms")
+    if num_incomplete_group_tracks:
+        LOG.warning(f"ANALYSIS: {num_incomplete_group_tracks} subscriber tracks had incomplete groups")
+    if num_stale_tracks:
+        LOG.warning(f"ANALYSIS: {num_stale_tracks} subscriber tracks received objects past their TTL")
+    if num_priority_inversions:
+        LOG.warning(f"ANALYSIS: {num_priority_inversions} objects arrived after later published lower priority objects")
+    if num_record_drops:
+        LOG.warning(f"ANALYSIS: {num_record_drops} subscriber tracks dropped records, increase --agg_threads")
+    if num_corrupt_tracks:
+        LOG.warning(f"ANALYSIS: {num_corrupt_tracks} subscriber tracks received corrupt objects")
 
-    if num_delayed == 0 and num_lost_objects == 0 and num_not_completed == 0:
+    num_issues = (num_delayed + num_lost_objects + num_not_completed + num_saturated + num_log_drops
+                  + num_out_of_sync + num_incomplete_group_tracks + num_stale_tracks + num_priority_inversions
+                  + num_priority_latency_inversions + num_record_drops + num_corrupt_tracks)
+    if num_issues == 0:
         LOG.info("ANALYSIS: No issues found")
 
 @click.command(context_settings=dict(help_option_names=['-h', '--help'], max_content_width=200))
@@ -80,13 +500,19 @@ def process_sub_logs_path(path):
 @click.option('-d', '--debug', 'debug',
               help="Enable debug logging",
               is_flag=True, default=False)
-def main(path, debug):
+@click.option('-t', '--trace_dir', 'trace_dir',
+              help="Directory of the subscriber traces to report the fan-out skew from", metavar='<path>', default=None)
+def main(path, debug, trace_dir):
     if debug:
         LOG.setLevel(logging.DEBUG)
 
     LOG.info(f"Reading all qperf subscriber log files in directory {path}")
 
+    process_netem_logs_path(path)
     process_sub_logs_path(path)
+    process_fetch_logs_path(path)
+    if trace_dir:
+        process_fanout_traces_path(trace_dir)
 
 if __name__ == '__main__':
     main()
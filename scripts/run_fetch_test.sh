@@ -0,0 +1,61 @@
+#!/bin/sh
+
+LOGS_DIR=qperf_logs
+
+if [ -z "$1" ]; then
+    echo "Using default number of subscriber clients"
+    NUM_SUBS=10
+else
+    NUM_SUBS=$1
+fi
+
+if [ -z "$2" ]; then
+    echo "Using default number of fetch clients"
+    NUM_FETCH=10
+else
+    NUM_FETCH=$2
+fi
+
+if [ -z "$3" ]; then
+    RELAY="moq://localhost:33435"
+else
+    RELAY="$3"
+fi
+
+if [ -z "$4" ]; then
+    echo "Config file is required"
+    exit 1
+else
+    CONFIG_PATH="$4"
+fi
+
+if [ -z "$5" ]; then
+    FETCHES=1
+else
+    FETCHES=$5
+fi
+
+echo "Running 1 publisher, $NUM_SUBS subscriber clients and $NUM_FETCH fetch clients with $FETCHES fetches each"
+
+rm -rf $LOGS_DIR
+mkdir -p $LOGS_DIR
+
+./qperf_pub -c $CONFIG_PATH --connect_uri $RELAY > $LOGS_DIR/pub.txt 2>&1 &
+PUB_PID=$!
+
+# Give the publisher time to announce before the subscribers arrive
+sleep 1
+
+if [ "$NUM_SUBS" -gt 0 ]; then
+    parallel -j ${NUM_SUBS} "./qperf_sub -i {} -c $CONFIG_PATH --connect_uri $RELAY > $LOGS_DIR/t_{}logs.txt 2>&1" ::: $(seq ${NUM_SUBS}) &
+    SUBS_PID=$!
+fi
+
+if [ "$NUM_FETCH" -gt 0 ]; then
+    parallel -j ${NUM_FETCH} "./qperf_fetch -i {} -n $FETCHES -c $CONFIG_PATH --connect_uri $RELAY > $LOGS_DIR/f_{}logs.txt 2>&1" ::: $(seq ${NUM_FETCH})
+fi
+
+if [ -n "$SUBS_PID" ]; then
+    wait $SUBS_PID
+fi
+wait $PUB_PID
@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# Run mixed priority tracks through a rate limited qperf_netem proxy to check that the relay favours
+# the higher priority tracks when the bottleneck is congested. The publisher connects to the relay
+# directly, the subscribers connect through the proxy so the relay's egress is the bottleneck.
+#
+# usage: run_priority_test.sh <relay uri> [config] [netem config] [subscribers] [proxy port]
+
+LOGS_DIR=qperf_logs
+
+if [ -z "$1" ]; then
+    echo "Relay URI is required, e.g. moq://localhost:33435"
+    exit 1
+else
+    RELAY="$1"
+fi
+
+CONFIG_PATH=${2:-../examples/config-priority.ini}
+NETEM_PATH=${3:-../examples/netem-priority.ini}
+NUM_SUBS=${4:-1}
+PROXY_PORT=${5:-1235}
+
+echo "Running 1 publisher and $NUM_SUBS subscribers through a bottleneck on port $PROXY_PORT"
+
+rm -rf $LOGS_DIR
+mkdir -p $LOGS_DIR
+
+./qperf_netem -c $NETEM_PATH --listen_port $PROXY_PORT --connect_uri $RELAY > $LOGS_DIR/netem.txt 2>&1 &
+NETEM_PID=$!
+sleep 1
+
+./qperf_pub -c $CONFIG_PATH --connect_uri $RELAY > $LOGS_DIR/pub.txt 2>&1 &
+PUB_PID=$!
+sleep 1
+
+SUB_PIDS=""
+for i in $(seq $NUM_SUBS); do
+    ./qperf_sub -i $i -c $CONFIG_PATH --connect_uri moq://localhost:$PROXY_PORT > $LOGS_DIR/t_${i}logs.txt 2>&1 &
+    SUB_PIDS="$SUB_PIDS $!"
+done
+
+wait $PUB_PID $SUB_PIDS
+kill -INT $NETEM_PID
+wait $NETEM_PID
@@ -0,0 +1,60 @@
+#!/bin/sh
+#
+# Kill and restart a local relay during a test to measure client outage recovery.
+#
+# usage: run_relay_restart.sh "<relay command>" <relay uri> <config> [kill at s] [outage s] [subscribers]
+
+LOGS_DIR=qperf_logs
+
+if [ -z "$1" ]; then
+    echo "Relay command is required, e.g. \"./qrelay -p 33435\""
+    exit 1
+else
+    RELAY_CMD="$1"
+fi
+
+if [ -z "$2" ]; then
+    RELAY="moq://localhost:33435"
+else
+    RELAY="$2"
+fi
+
+if [ -z "$3" ]; then
+    echo "Config file is required"
+    exit 1
+else
+    CONFIG_PATH="$3"
+fi
+
+KILL_AT=${4:-15}
+OUTAGE=${5:-5}
+NUM_SUBS=${6:-2}
+
+rm -rf $LOGS_DIR
+mkdir -p $LOGS_DIR
+
+$RELAY_CMD > $LOGS_DIR/relay_1.txt 2>&1 &
+RELAY_PID=$!
+sleep 1
+
+./qperf_pub -c $CONFIG_PATH --connect_uri $RELAY --reconnect > $LOGS_DIR/pub.txt 2>&1 &
+PUB_PID=$!
+sleep 1
+
+SUB_PIDS=""
+for i in $(seq $NUM_SUBS); do
+    ./qperf_sub -i $i -c $CONFIG_PATH --connect_uri $RELAY --reconnect > $LOGS_DIR/t_${i}logs.txt 2>&1 &
+    SUB_PIDS="$SUB_PIDS $!"
+done
+
+sleep $KILL_AT
+echo "Killing relay for $OUTAGE seconds"
+kill -9 $RELAY_PID
+sleep $OUTAGE
+
+$RELAY_CMD > $LOGS_DIR/relay_2.txt 2>&1 &
+RELAY_PID=$!
+echo "Relay restarted"
+
+wait $PUB_PID $SUB_PIDS
+kill $RELAY_PID
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "arrival_model.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace qperf {
+    namespace {
+        // Bounds the memory of very long or very fast tracks, longer tests reuse the schedule
+        constexpr std::size_t kMaxScheduleLength = 1 << 20;
+
+        ArrivalProcess ParseArrivalProcess(const std::string& value)
+        {
+            if (value == "poisson") {
+                return ArrivalProcess::kPoisson;
+            }
+            if (value == "onoff") {
+                return ArrivalProcess::kOnOff;
+            }
+            if (value == "sync_burst") {
+                return ArrivalProcess::kSyncBurst;
+            }
+            if (value != "periodic") {
+                SPDLOG_WARN("Invalid arrival '{}'. Using default `periodic`", value);
+            }
+            return ArrivalProcess::kPeriodic;
+        }
+
+        std::uint32_t ToGap(double gap_us)
+        {
+            return static_cast<std::uint32_t>(std::clamp(std::round(gap_us), 0.0, double(UINT32_MAX)));
+        }
+    }
+
+    bool PopulateArrivalProcess(const ini::IniSection& section, ArrivalConfig& config)
+    {
+        config.process = ParseArrivalProcess(ValueOrDefault<std::string>(section, "arrival", "periodic"));
+        config.seed = ValueOrDefault<std::uint64_t>(section, "arrival_seed", 1);
+        config.on_time = ValueOrDefault<double>(section, "on_time", 1000.0);
+        config.off_time = ValueOrDefault<double>(section, "off_time", 1000.0);
+        config.burst_period = ValueOrDefault<std::uint64_t>(section, "burst_period", 1000);
+        config.burst_size = ValueOrDefault<std::uint32_t>(section, "burst_size", 1);
+        config.burst_spacing = ValueOrDefault<std::uint32_t>(section, "burst_spacing", 0);
+
+        if (config.process == ArrivalProcess::kSyncBurst &&
+            (config.burst_period == 0 || config.burst_size == 0 || config.burst_size > kMaxScheduleLength ||
+             std::uint64_t(config.burst_size - 1) * config.burst_spacing >= config.burst_period * 1000)) {
+            SPDLOG_WARN("Invalid burst_period {} ms, burst_size {}, burst_spacing {} us. Using `periodic`",
+                        config.burst_period,
+                        config.burst_size,
+                        config.burst_spacing);
+            config.process = ArrivalProcess::kPeriodic;
+        }
+
+        return true;
+    }
+
+    ArrivalSchedule ArrivalSchedule::Build(const ArrivalConfig& arrival_config, const PerfConfig& perf_config)
+    {
+        ArrivalSchedule schedule;
+        if (arrival_config.process == ArrivalProcess::kPeriodic) {
+            return schedule;
+        }
+
+        const double interval_us = std::max(perf_config.transmit_interval, 0.001) * 1000.0;
+        const double duration_us = std::max<double>(perf_config.total_transmit_time, 1.0) * 1000.0;
+
+        std::mt19937_64 rng(arrival_config.seed);
+        double elapsed_us = 0;
+
+        switch (arrival_config.process) {
+            case ArrivalProcess::kPoisson: {
+                std::exponential_distribution<double> gap(1.0 / interval_us);
+                while (elapsed_us < duration_us && schedule.gaps_.size() < kMaxScheduleLength) {
+                    schedule.gaps_.push_back(ToGap(gap(rng)));
+                    elapsed_us += schedule.gaps_.back();
+                }
+                break;
+            }
+            case ArrivalProcess::kOnOff: {
+                // Two state Markov chain, exponential holding times in each state
+                std::exponential_distribution<double> on_period(1.0 / std::max(arrival_config.on_time * 1000.0, 1.0));
+                std::exponential_distribution<double> off_period(1.0 / std::max(arrival_config.off_time * 1000.0, 1.0));
+                while (elapsed_us < duration_us && schedule.gaps_.size() < kMaxScheduleLength) {
+                    const auto on_objects = std::max<std::uint64_t>(1, std::llround(on_period(rng) / interval_us));
+                    for (std::uint64_t i = 1; i < on_objects && schedule.gaps_.size() < kMaxScheduleLength; ++i) {
+                        schedule.gaps_.push_back(ToGap(interval_us));
+                        elapsed_us += interval_us;
+                    }
+                    schedule.gaps_.push_back(ToGap(interval_us + off_period(rng)));
+                    elapsed_us += schedule.gaps_.back();
+                }
+                break;
+            }
+            case ArrivalProcess::kSyncBurst: {
+                const auto period_us = arrival_config.burst_period * 1000;
+                const auto burst_us = std::uint64_t(arrival_config.burst_size - 1) * arrival_config.burst_spacing;
+                // Whole bursts only, a wrapped schedule keeps the bursts on the epoch boundaries
+                while (elapsed_us < duration_us &&
+                       schedule.gaps_.size() + arrival_config.burst_size <= kMaxScheduleLength) {
+                    for (std::uint32_t i = 1; i < arrival_config.burst_size; ++i) {
+                        schedule.gaps_.push_back(arrival_config.burst_spacing);
+                    }
+                    schedule.gaps_.push_back(ToGap(period_us - burst_us));
+                    elapsed_us += period_us;
+                }
+                schedule.align_us_ = period_us;
+                schedule.align_objects_ = arrival_config.burst_size;
+                break;
+            }
+            default:
+                break;
+        }
+
+        return schedule;
+    }
+
+    std::string ArrivalProcessToString(ArrivalProcess process)
+    {
+        switch (process) {
+            case ArrivalProcess::kPoisson:
+                return "poisson";
+            case ArrivalProcess::kOnOff:
+                return "onoff";
+            case ArrivalProcess::kSyncBurst:
+                return "sync_burst";
+            default:
+                return "periodic";
+        }
+    }
+} // namespace qperf
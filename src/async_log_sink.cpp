@@ -0,0 +1,196 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "async_log_sink.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+namespace qperf {
+    namespace {
+        constexpr std::size_t kWriteBatchSize = 64 * 1024;
+
+        std::weak_ptr<AsyncLogSink> default_sink;
+
+        /**
+         * @brief Format the date and time of a log line, reusing the previous result within the same second
+         */
+        std::string_view FormatTimePrefix(std::time_t seconds)
+        {
+            thread_local std::time_t cached_seconds = 0;
+            thread_local char cached_prefix[32];
+            thread_local std::size_t cached_size = 0;
+
+            if (seconds != cached_seconds) {
+                std::tm tm;
+                localtime_r(&seconds, &tm);
+                cached_size = std::strftime(cached_prefix, sizeof(cached_prefix), "%Y-%m-%d %H:%M:%S", &tm);
+                cached_seconds = seconds;
+            }
+
+            return { cached_prefix, cached_size };
+        }
+
+        std::size_t RoundUpPowerOfTwo(std::size_t value)
+        {
+            std::size_t result = 1;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+    }
+
+    AsyncLogSink::AsyncLogSink(std::FILE* file, std::size_t queue_size)
+      : file_(file)
+      , mask_(RoundUpPowerOfTwo(std::max<std::size_t>(queue_size, 2)) - 1)
+      , slots_(new Slot[mask_ + 1])
+      , enqueue_pos_(0)
+      , dequeue_pos_(0)
+      , dropped_(0)
+      , terminate_(false)
+    {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        writer_thread_ = std::thread([this] { WriterThread(); });
+    }
+
+    AsyncLogSink::~AsyncLogSink()
+    {
+        terminate_ = true;
+        if (writer_thread_.joinable()) {
+            writer_thread_.join();
+        }
+
+        if (dropped_ > 0) {
+            std::fprintf(file_, "AsyncLogSink dropped %llu log lines\n", static_cast<unsigned long long>(dropped_));
+        }
+        std::fflush(file_);
+    }
+
+    void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+    {
+        // Bounded multi-producer queue, a producer claims a slot by advancing enqueue_pos_
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            const auto sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::int64_t>(sequence) - static_cast<std::int64_t>(pos);
+
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        const auto since_epoch = msg.time.time_since_epoch();
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(since_epoch - seconds);
+        const auto level = spdlog::level::to_string_view(msg.level);
+
+        auto result = fmt::format_to_n(slot->data,
+                                       kMaxLineSize - 1,
+                                       "[{}.{:06}] [{}] [{}] {}",
+                                       FormatTimePrefix(static_cast<std::time_t>(seconds.count())),
+                                       micros.count(),
+                                       fmt::string_view(msg.logger_name.data(), msg.logger_name.size()),
+                                       fmt::string_view(level.data(), level.size()),
+                                       fmt::string_view(msg.payload.data(), msg.payload.size()));
+
+        // Truncated lines keep their newline
+        const auto size = std::min<std::size_t>(result.size, kMaxLineSize - 1);
+        slot->data[size] = '\n';
+        slot->size = static_cast<std::uint32_t>(size + 1);
+
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    std::size_t AsyncLogSink::Drain(char* batch, std::size_t batch_size)
+    {
+        std::size_t used = 0;
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+
+        for (;;) {
+            auto& slot = slots_[pos & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+
+            if (used + slot.size > batch_size) {
+                std::fwrite(batch, 1, used, file_);
+                used = 0;
+            }
+
+            std::memcpy(batch + used, slot.data, slot.size);
+            used += slot.size;
+
+            slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+            pos += 1;
+        }
+
+        if (used > 0) {
+            std::fwrite(batch, 1, used, file_);
+            std::fflush(file_);
+        }
+
+        const auto drained = pos - dequeue_pos_.load(std::memory_order_relaxed);
+        dequeue_pos_.store(pos, std::memory_order_release);
+        return drained;
+    }
+
+    void AsyncLogSink::WriterThread()
+    {
+        std::unique_ptr<char[]> batch(new char[kWriteBatchSize]);
+
+        while (!terminate_) {
+            if (Drain(batch.get(), kWriteBatchSize) == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        Drain(batch.get(), kWriteBatchSize);
+    }
+
+    void AsyncLogSink::flush()
+    {
+        const auto target = enqueue_pos_.load(std::memory_order_acquire);
+        while (!terminate_ && dequeue_pos_.load(std::memory_order_acquire) < target) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::shared_ptr<spdlog::logger> CreateAsyncLogger(const std::string& name, std::size_t queue_size)
+    {
+        auto sink = std::make_shared<AsyncLogSink>(stderr, queue_size);
+        auto logger = std::make_shared<spdlog::logger>(name, sink);
+
+        default_sink = sink;
+        spdlog::register_logger(logger);
+        spdlog::set_default_logger(logger);
+
+        return logger;
+    }
+
+    void ReportAsyncLogger(const std::string& endpoint_id)
+    {
+        auto sink = default_sink.lock();
+        if (!sink) {
+            return;
+        }
+
+        sink->flush();
+        SPDLOG_INFO("LOG COMPLETE, {}, {}", endpoint_id, sink->Dropped());
+        sink->flush();
+    }
+} // namespace qperf
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "control_track_handler.hpp"
+#include "time_source.hpp"
+
+namespace qperf {
+    void ControlTiming::Start()
+    {
+        start_us_ = TimeSource::MonotonicNowUs();
+    }
+
+    void ControlTiming::Respond(bool ok)
+    {
+        if (result_.load(std::memory_order_relaxed) != ControlResult::kPending) {
+            return;
+        }
+
+        // Only the transport thread responds, the release orders the response time before the result
+        response_us_ = TimeSource::MonotonicNowUs();
+        result_.store(ok ? ControlResult::kOk : ControlResult::kFailed, std::memory_order_release);
+    }
+
+    ControlPublishTrackHandler::ControlPublishTrackHandler(const quicr::FullTrackName& full_track_name)
+      : PublishTrackHandler(full_track_name, quicr::TrackMode::kStream, 0, 1000)
+    {
+    }
+
+    void ControlPublishTrackHandler::StatusChanged(Status status)
+    {
+        switch (status) {
+            // Still waiting on the announce response
+            case Status::kNotConnected:
+            case Status::kNotAnnounced:
+            case Status::kPendingAnnounceResponse:
+            case Status::kSendingUnannounce:
+                break;
+            case Status::kAnnounceNotAuthorized:
+                timing_.Respond(false);
+                break;
+            default:
+                // Announced, with or without subscribers
+                timing_.Respond(true);
+                break;
+        }
+    }
+
+    ControlSubscribeTrackHandler::ControlSubscribeTrackHandler(const quicr::FullTrackName& full_track_name)
+      : SubscribeTrackHandler(full_track_name,
+                              0,
+                              quicr::messages::GroupOrder::kOriginalPublisherOrder,
+                              quicr::messages::FilterType::kLargestObject)
+    {
+    }
+
+    void ControlSubscribeTrackHandler::StatusChanged(Status status)
+    {
+        switch (status) {
+            case Status::kOk:
+                timing_.Respond(true);
+                break;
+            case Status::kError:
+            case Status::kNotAuthorized:
+                timing_.Respond(false);
+                break;
+            default:
+                break;
+        }
+    }
+} // namespace qperf
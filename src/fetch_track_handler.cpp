@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "fetch_track_handler.hpp"
+#include "layer_schedule.hpp"
+#include "time_source.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace qperf {
+    bool PopulateFetchConfig(const ini::IniSection& section, FetchConfig& config)
+    {
+        config.delay = ValueOrDefault<std::uint64_t>(section, "fetch_delay", 15000);
+        // Publishers number their groups from 1
+        config.start_group = ValueOrDefault<std::uint64_t>(section, "fetch_start_group", 1);
+        config.groups = ValueOrDefault<std::uint64_t>(section, "fetch_groups", 10);
+        config.timeout = ValueOrDefault<std::uint64_t>(section, "fetch_timeout", 5000);
+
+        if (config.groups == 0) {
+            SPDLOG_WARN("fetch_groups must be at least 1. Using 1");
+            config.groups = 1;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief  Fetch track handler
+     * @details Fetch track handler used by the fetch benchmark client. The end object of 0 requests the
+     *          whole end group.
+     */
+    PerfFetchTrackHandler::PerfFetchTrackHandler(const PerfConfig& perf_config,
+                                                 const FetchConfig& fetch_config,
+                                                 std::uint32_t test_identifier,
+                                                 std::uint32_t fetch_index)
+      : FetchTrackHandler(perf_config.full_track_name,
+                          perf_config.priority,
+                          quicr::messages::GroupOrder::kAscending,
+                          fetch_config.start_group,
+                          fetch_config.start_group + fetch_config.groups - 1,
+                          0,
+                          0)
+      , perf_config_(perf_config)
+      , fetch_config_(fetch_config)
+      , test_identifier_(test_identifier)
+      , fetch_index_(fetch_index)
+      , group_objects_(fetch_config.groups, 0)
+      , group_lengths_(fetch_config.groups, std::max<std::uint32_t>(perf_config.objects_per_group, 1))
+      , complete_(false)
+      , timed_out_(false)
+      , reported_(false)
+      , fetch_time_(0)
+      , first_object_time_(0)
+      , last_object_time_(0)
+      , objects_(0)
+      , bytes_(0)
+      , max_object_age_(0)
+      , expected_objects_(fetch_config.groups * std::max<std::uint32_t>(perf_config.objects_per_group, 1))
+      , end_group_open_(false)
+    {
+    }
+
+    std::shared_ptr<PerfFetchTrackHandler> PerfFetchTrackHandler::Create(const std::string& section_name,
+                                                                         ini::IniFile& inif,
+                                                                         std::uint32_t test_identifier,
+                                                                         std::uint32_t fetch_index)
+    {
+        PerfConfig perf_config;
+        PopulateScenarioFields(section_name, 0, inif, perf_config);
+        FetchConfig fetch_config;
+        PopulateFetchConfig(inif[section_name], fetch_config);
+
+        // The fetch expects every object of a group, a layered group has one per layer on each tick
+        const auto layer_schedule = LayerSchedule::Build(inif[section_name], perf_config);
+        if (!layer_schedule.Empty()) {
+            perf_config.objects_per_group = static_cast<std::uint32_t>(layer_schedule.ObjectsPerGroup());
+        }
+
+        return std::shared_ptr<PerfFetchTrackHandler>(
+          new PerfFetchTrackHandler(perf_config, fetch_config, test_identifier, fetch_index));
+    }
+
+    void PerfFetchTrackHandler::Fetching()
+    {
+        fetch_time_ = TimeSource::Instance().EpochNowUs();
+        last_object_time_ = fetch_time_.load();
+    }
+
+    void PerfFetchTrackHandler::StatusChanged(Status status)
+    {
+        switch (status) {
+            case Status::kOk:
+                SPDLOG_INFO("{}, {}, {} Fetch Handler - kOk", test_identifier_, perf_config_.test_name, fetch_index_);
+                break;
+            case Status::kPendingResponse:
+                SPDLOG_INFO("{}, {}, {} Fetch Handler - kPendingResponse",
+                            test_identifier_,
+                            perf_config_.test_name,
+                            fetch_index_);
+                break;
+
+            // rest of these end the fetch
+            case Status::kNotSubscribed:
+            case Status::kSendingUnsubscribe:
+            case Status::kError:
+            case Status::kNotAuthorized:
+            default:
+                SPDLOG_INFO("{}, {}, {} Fetch Handler - status {}",
+                            test_identifier_,
+                            perf_config_.test_name,
+                            fetch_index_,
+                            static_cast<int>(status));
+                complete_ = true;
+                break;
+        }
+    }
+
+    void PerfFetchTrackHandler::ObjectReceived(const quicr::ObjectHeaders& object_header, quicr::BytesSpan data_span)
+    {
+        const auto now = TimeSource::Instance().EpochNowUs();
+
+        std::uint64_t none = 0;
+        first_object_time_.compare_exchange_strong(none, now);
+        last_object_time_ = now;
+        bytes_ += data_span.size();
+
+        const auto group = object_header.group_id - fetch_config_.start_group;
+        const auto in_range = object_header.group_id >= fetch_config_.start_group && group < group_objects_.size();
+        if (in_range) {
+            group_objects_[group] += 1;
+        }
+
+        // Age of the object in the relay cache, from the publish time in the test header
+        if (data_span.size() >= sizeof(ObjectTestHeader)) {
+            ObjectTestHeader test_header;
+            std::memcpy(&test_header, data_span.data(), sizeof(test_header));
+            if (test_header.test_mode == TestMode::kRunning && now > test_header.time) {
+                max_object_age_ = std::max<std::uint64_t>(max_object_age_, now - test_header.time);
+            }
+
+            // The object carries the length of the group before it, shorter after a new group request
+            if (in_range && group > 0 && test_header.previous_group_objects != 0 &&
+                group_lengths_[group - 1] != test_header.previous_group_objects) {
+                group_lengths_[group - 1] = test_header.previous_group_objects;
+                std::uint64_t expected_objects = 0;
+                for (const auto length : group_lengths_) {
+                    expected_objects += length;
+                }
+                expected_objects_ = expected_objects;
+            }
+        }
+
+        bool end_group_open = group_objects_.back() > 0;
+        for (std::size_t i = 0; end_group_open && i + 1 < group_objects_.size(); ++i) {
+            end_group_open = group_objects_[i] >= group_lengths_[i];
+        }
+        end_group_open_ = end_group_open;
+
+        if (objects_.fetch_add(1) + 1 >= expected_objects_) {
+            complete_ = true;
+        }
+    }
+
+    bool PerfFetchTrackHandler::CheckComplete()
+    {
+        if (complete_) {
+            return true;
+        }
+
+        const std::uint64_t fetch_time = fetch_time_;
+        if (fetch_time == 0) {
+            return false;
+        }
+
+        const auto quiet_time = TimeSource::Instance().EpochNowUs() - last_object_time_;
+        if (end_group_open_ && quiet_time > std::min(kEndGroupSettleMs, fetch_config_.timeout) * 1000) {
+            // The end group ended early, it is as long as what arrived
+            expected_objects_ = objects_.load();
+            complete_ = true;
+            return true;
+        }
+
+        if (quiet_time > fetch_config_.timeout * 1000) {
+            SPDLOG_WARN("{}, {}, {} Fetch timed out after {} of {} objects",
+                        test_identifier_,
+                        perf_config_.test_name,
+                        fetch_index_,
+                        objects_.load(),
+                        expected_objects_.load());
+            timed_out_ = true;
+            complete_ = true;
+        }
+
+        return complete_;
+    }
+
+    void PerfFetchTrackHandler::Report()
+    {
+        if (reported_) {
+            return;
+        }
+        reported_ = true;
+
+        const std::uint64_t fetch_time = fetch_time_;
+        const std::uint64_t first_object_time = first_object_time_;
+        const std::uint64_t last_object_time = last_object_time_;
+
+        const auto since_fetch = [fetch_time](std::uint64_t time) -> std::int64_t {
+            return fetch_time && time ? static_cast<std::int64_t>(time - fetch_time) : -1;
+        };
+        const auto transfer_time = first_object_time ? last_object_time - first_object_time : 0;
+        const auto bitrate = transfer_time ? bytes_ * 8 * 1'000'000 / transfer_time : 0;
+
+        // id,test_name,fetch_index,start_group,groups,objects,expected_objects,bytes,first_object_us,
+        //       completion_us,bitrate,max_object_age_us,timed_out
+        SPDLOG_INFO("FETCH COMPLETE, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+                    test_identifier_,
+                    perf_config_.test_name,
+                    fetch_index_,
+                    fetch_config_.start_group,
+                    fetch_config_.groups,
+                    objects_.load(),
+                    expected_objects_.load(),
+                    bytes_.load(),
+                    since_fetch(first_object_time),
+                    since_fetch(first_object_time ? last_object_time : 0),
+                    bitrate,
+                    max_object_age_.load(),
+                    timed_out_ ? 1 : 0);
+    }
+} // namespace qperf
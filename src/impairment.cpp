@@ -0,0 +1,250 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "impairment.hpp"
+#include "qperf.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace qperf {
+    namespace {
+        constexpr double kParetoShape = 3.0;
+
+        DelayDistribution ParseDelayDistribution(const std::string& value)
+        {
+            if (value == "uniform") {
+                return DelayDistribution::kUniform;
+            }
+            if (value == "normal") {
+                return DelayDistribution::kNormal;
+            }
+            if (value == "pareto") {
+                return DelayDistribution::kPareto;
+            }
+            if (value != "constant") {
+                SPDLOG_WARN("Invalid delay_distribution '{}'. Using default `constant`", value);
+            }
+            return DelayDistribution::kConstant;
+        }
+
+        LossModel ParseLossModel(const std::string& value)
+        {
+            if (value == "bernoulli") {
+                return LossModel::kBernoulli;
+            }
+            if (value == "gilbert_elliott") {
+                return LossModel::kGilbertElliott;
+            }
+            if (value != "none") {
+                SPDLOG_WARN("Invalid loss_model '{}'. Using default `none`", value);
+            }
+            return LossModel::kNone;
+        }
+    }
+
+    ImpairmentEngine::ImpairmentEngine(const std::vector<ImpairmentConfig>& schedule, std::uint64_t seed)
+      : schedule_(schedule)
+      , phase_index_(0)
+      , rng_(seed)
+      , uniform_(0.0, 1.0)
+      , ge_bad_state_(false)
+      , start_time_(Clock::now())
+      , link_free_time_(start_time_)
+    {
+        if (schedule_.empty()) {
+            schedule_.push_back(ImpairmentConfig{});
+            schedule_.back().name = "none";
+        }
+        memset(&stats_, '\0', sizeof(stats_));
+    }
+
+    bool ImpairmentEngine::UpdatePhase(Clock::time_point now)
+    {
+        const auto elapsed_ms =
+          static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time_).count());
+
+        auto index = phase_index_;
+        while (index + 1 < schedule_.size() && schedule_[index + 1].start_time <= elapsed_ms) {
+            index += 1;
+        }
+
+        if (index == phase_index_) {
+            return false;
+        }
+
+        phase_index_ = index;
+        ge_bad_state_ = false;
+        return true;
+    }
+
+    bool ImpairmentEngine::Chance(double percent)
+    {
+        if (percent <= 0.0) {
+            return false;
+        }
+        return uniform_(rng_) * 100.0 < percent;
+    }
+
+    double ImpairmentEngine::SampleDelay(const ImpairmentConfig& config)
+    {
+        double delay = config.delay;
+
+        switch (config.delay_distribution) {
+            case DelayDistribution::kConstant:
+                break;
+            case DelayDistribution::kUniform:
+                delay += (uniform_(rng_) * 2.0 - 1.0) * config.jitter;
+                break;
+            case DelayDistribution::kNormal:
+                // The distribution requires a positive stddev, no jitter is a constant delay
+                if (config.jitter > 0.0) {
+                    delay += std::normal_distribution<double>(0.0, config.jitter)(rng_);
+                }
+                break;
+            case DelayDistribution::kPareto: {
+                // Heavy tail above the base delay with a mean of jitter
+                const double u = std::max(uniform_(rng_), 1e-12);
+                delay += config.jitter * (kParetoShape - 1.0) * (std::pow(u, -1.0 / kParetoShape) - 1.0);
+                break;
+            }
+        }
+
+        return std::max(delay, 0.0);
+    }
+
+    bool ImpairmentEngine::SampleLoss(const ImpairmentConfig& config)
+    {
+        switch (config.loss_model) {
+            case LossModel::kNone:
+                return false;
+            case LossModel::kBernoulli:
+                return Chance(config.loss);
+            case LossModel::kGilbertElliott:
+                if (ge_bad_state_) {
+                    ge_bad_state_ = !Chance(config.ge_r);
+                } else {
+                    ge_bad_state_ = Chance(config.ge_p);
+                }
+                return Chance(ge_bad_state_ ? config.ge_loss_bad : config.ge_loss_good);
+        }
+
+        return false;
+    }
+
+    std::optional<ImpairmentEngine::Clock::time_point> ImpairmentEngine::Apply(Clock::time_point now,
+                                                                               std::size_t packet_size)
+    {
+        const auto& config = schedule_[phase_index_];
+
+        stats_.packets += 1;
+        stats_.bytes += packet_size;
+
+        if (SampleLoss(config)) {
+            stats_.dropped_loss += 1;
+            return std::nullopt;
+        }
+
+        // Bottleneck queue, packets are serialized at rate after waiting for the link to be free
+        auto departure = now;
+        if (config.rate > 0) {
+            auto tx_start = std::max(now, link_free_time_);
+            auto queue_delay = std::chrono::duration<double, std::milli>(tx_start - now).count();
+            if (config.queue_limit > 0 && queue_delay > config.queue_limit) {
+                stats_.dropped_queue += 1;
+                return std::nullopt;
+            }
+
+            // rate is in Kbps, which is bits per ms
+            auto tx_time_us = static_cast<std::int64_t>((packet_size * 8 * 1000) / config.rate);
+            link_free_time_ = tx_start + std::chrono::microseconds(tx_time_us);
+            departure = link_free_time_;
+        }
+
+        double delay_ms = SampleDelay(config);
+        if (Chance(config.reorder)) {
+            delay_ms += config.reorder_delay;
+            stats_.reordered += 1;
+        }
+
+        return departure + std::chrono::microseconds(static_cast<std::int64_t>(delay_ms * 1000.0));
+    }
+
+    void ImpairmentEngine::DroppedQueue(std::size_t packet_size)
+    {
+        stats_.packets += 1;
+        stats_.bytes += packet_size;
+        stats_.dropped_queue += 1;
+    }
+
+    void ImpairmentEngine::Forwarded(std::chrono::microseconds delay)
+    {
+        const auto delay_us = static_cast<std::uint64_t>(std::max(delay.count(), std::int64_t(0)));
+        stats_.forwarded += 1;
+        stats_.total_delay_us += delay_us;
+        stats_.max_delay_us = std::max(stats_.max_delay_us, delay_us);
+    }
+
+    bool PopulateImpairmentSchedule(ini::IniFile& inif, std::vector<ImpairmentConfig>& schedule)
+    {
+        schedule.clear();
+
+        for (const auto& [section_name, section] : inif) {
+            ImpairmentConfig config;
+            config.name = section_name;
+            config.start_time = ValueOrDefault<std::uint64_t>(section, "start_time", 0);
+            config.delay = ValueOrDefault<double>(section, "delay", 0.0);
+            config.jitter = ValueOrDefault<double>(section, "jitter", 0.0);
+            config.delay_distribution =
+              ParseDelayDistribution(ValueOrDefault<std::string>(section, "delay_distribution", "constant"));
+            config.loss_model = ParseLossModel(ValueOrDefault<std::string>(section, "loss_model", "none"));
+            config.loss = ValueOrDefault<double>(section, "loss", 0.0);
+            config.ge_p = ValueOrDefault<double>(section, "ge_p", 0.0);
+            config.ge_r = ValueOrDefault<double>(section, "ge_r", 100.0);
+            config.ge_loss_good = ValueOrDefault<double>(section, "ge_loss_good", 0.0);
+            config.ge_loss_bad = ValueOrDefault<double>(section, "ge_loss_bad", 100.0);
+            config.reorder = ValueOrDefault<double>(section, "reorder", 0.0);
+            config.reorder_delay = ValueOrDefault<double>(section, "reorder_delay", 0.0);
+            config.rate = ValueOrDefault<std::uint64_t>(section, "rate", 0);
+            config.queue_limit = ValueOrDefault<double>(section, "queue_limit", 0.0);
+
+            schedule.push_back(config);
+        }
+
+        std::stable_sort(schedule.begin(), schedule.end(), [](const auto& a, const auto& b) {
+            return a.start_time < b.start_time;
+        });
+
+        if (schedule.empty()) {
+            SPDLOG_WARN("Impairment schedule has no phases");
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string ImpairmentToString(const ImpairmentConfig& config)
+    {
+        return fmt::format("{}: start {} ms, delay {} ms, jitter {} ms, dist {}, loss_model {}, loss {}%, "
+                           "ge p/r {}%/{}%, ge loss good/bad {}%/{}%, reorder {}% +{} ms, rate {} Kbps, "
+                           "queue_limit {} ms",
+                           config.name,
+                           config.start_time,
+                           config.delay,
+                           config.jitter,
+                           static_cast<int>(config.delay_distribution),
+                           static_cast<int>(config.loss_model),
+                           config.loss,
+                           config.ge_p,
+                           config.ge_r,
+                           config.ge_loss_good,
+                           config.ge_loss_bad,
+                           config.reorder,
+                           config.reorder_delay,
+                           config.rate,
+                           config.queue_limit);
+    }
+} // namespace qperf
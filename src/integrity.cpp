@@ -0,0 +1,203 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "integrity.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace qperf {
+    namespace {
+        using Crc32cFunction = std::uint32_t (*)(const std::uint8_t*, std::size_t, std::uint32_t);
+
+        std::array<std::uint32_t, 256> MakeCrc32cTable()
+        {
+            std::array<std::uint32_t, 256> table;
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        std::uint32_t Crc32cSoftware(const std::uint8_t* data, std::size_t size, std::uint32_t crc)
+        {
+            static const auto table = MakeCrc32cTable();
+            for (std::size_t i = 0; i < size; ++i) {
+                crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            }
+            return crc;
+        }
+
+#if defined(__x86_64__)
+        __attribute__((target("sse4.2"))) std::uint32_t Crc32cHardware(const std::uint8_t* data,
+                                                                        std::size_t size,
+                                                                        std::uint32_t crc)
+        {
+            std::uint64_t crc64 = crc;
+            for (; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t), data += sizeof(std::uint64_t)) {
+                std::uint64_t word;
+                std::memcpy(&word, data, sizeof(word));
+                crc64 = _mm_crc32_u64(crc64, word);
+            }
+
+            crc = static_cast<std::uint32_t>(crc64);
+            for (; size > 0; --size, ++data) {
+                crc = _mm_crc32_u8(crc, *data);
+            }
+            return crc;
+        }
+
+        Crc32cFunction SelectCrc32c()
+        {
+            return __builtin_cpu_supports("sse4.2") ? Crc32cHardware : Crc32cSoftware;
+        }
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+        std::uint32_t Crc32cHardware(const std::uint8_t* data, std::size_t size, std::uint32_t crc)
+        {
+            for (; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t), data += sizeof(std::uint64_t)) {
+                std::uint64_t word;
+                std::memcpy(&word, data, sizeof(word));
+                crc = __crc32cd(crc, word);
+            }
+
+            for (; size > 0; --size, ++data) {
+                crc = __crc32cb(crc, *data);
+            }
+            return crc;
+        }
+
+        Crc32cFunction SelectCrc32c()
+        {
+            return Crc32cHardware;
+        }
+#else
+        Crc32cFunction SelectCrc32c()
+        {
+            return Crc32cSoftware;
+        }
+#endif
+
+        std::uint64_t ObjectSeed(std::uint64_t group_id, std::uint64_t object_id)
+        {
+            return (group_id << 32) ^ object_id;
+        }
+
+        /**
+         * @brief splitmix64 of a counter, each pattern word is independent so the loops vectorize
+         */
+        inline std::uint64_t PatternWord(std::uint64_t seed, std::uint64_t index)
+        {
+            std::uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        void FillPattern(std::uint8_t* data, std::size_t size, std::uint64_t seed)
+        {
+            const std::size_t words = size / sizeof(std::uint64_t);
+            for (std::size_t i = 0; i < words; ++i) {
+                const auto word = PatternWord(seed, i);
+                std::memcpy(data + i * sizeof(word), &word, sizeof(word));
+            }
+
+            const auto tail = PatternWord(seed, words);
+            std::memcpy(data + words * sizeof(tail), &tail, size % sizeof(tail));
+        }
+
+        bool CheckPattern(const std::uint8_t* data, std::size_t size, std::uint64_t seed)
+        {
+            const std::size_t words = size / sizeof(std::uint64_t);
+            std::uint64_t diff = 0;
+            for (std::size_t i = 0; i < words; ++i) {
+                std::uint64_t word;
+                std::memcpy(&word, data + i * sizeof(word), sizeof(word));
+                diff |= word ^ PatternWord(seed, i);
+            }
+
+            const auto tail = PatternWord(seed, words);
+            return diff == 0 && std::memcmp(data + words * sizeof(tail), &tail, size % sizeof(tail)) == 0;
+        }
+
+        std::uint32_t ObjectCrc(std::uint64_t group_id,
+                                std::uint64_t object_id,
+                                const std::uint8_t* data,
+                                std::size_t size)
+        {
+            const auto seed = ObjectSeed(group_id, object_id);
+            return Crc32c(data, size, Crc32c(reinterpret_cast<const std::uint8_t*>(&seed), sizeof(seed)));
+        }
+    }
+
+    std::uint32_t Crc32c(const std::uint8_t* data, std::size_t size, std::uint32_t crc)
+    {
+        static const Crc32cFunction crc32c = SelectCrc32c();
+        return ~crc32c(data, size, ~crc);
+    }
+
+    void SealObject(IntegrityMode mode,
+                    std::uint64_t group_id,
+                    std::uint64_t object_id,
+                    std::uint8_t* data,
+                    std::size_t size)
+    {
+        if (mode == IntegrityMode::kNone || size < kIntegrityMinSize) {
+            return;
+        }
+
+        auto* payload = data + kIntegrityMinSize;
+        const auto payload_size = size - kIntegrityMinSize;
+
+        ObjectIntegrityHeader header;
+        std::memset(&header, '\0', sizeof(header));
+        header.payload_length = size;
+
+        if (mode == IntegrityMode::kPattern) {
+            FillPattern(payload, payload_size, ObjectSeed(group_id, object_id));
+        } else {
+            header.check = ObjectCrc(group_id, object_id, payload, payload_size);
+        }
+
+        std::memcpy(data + kIntegrityOffset, &header, sizeof(header));
+    }
+
+    IntegrityResult VerifyObject(IntegrityMode mode,
+                                 std::uint64_t group_id,
+                                 std::uint64_t object_id,
+                                 const std::uint8_t* data,
+                                 std::size_t size)
+    {
+        if (mode == IntegrityMode::kNone || size < kIntegrityMinSize) {
+            return IntegrityResult::kUnchecked;
+        }
+
+        ObjectIntegrityHeader header;
+        std::memcpy(&header, data + kIntegrityOffset, sizeof(header));
+
+        if (header.payload_length != size) {
+            return IntegrityResult::kSizeMismatch;
+        }
+
+        const auto* payload = data + kIntegrityMinSize;
+        const auto payload_size = size - kIntegrityMinSize;
+
+        bool intact;
+        if (mode == IntegrityMode::kPattern) {
+            intact = CheckPattern(payload, payload_size, ObjectSeed(group_id, object_id));
+        } else {
+            intact = header.check == ObjectCrc(group_id, object_id, payload, payload_size);
+        }
+
+        return intact ? IntegrityResult::kOk : IntegrityResult::kCorrupt;
+    }
+} // namespace qperf
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "join_scheduler.hpp"
+
+namespace qperf {
+    JoinScheduler::JoinScheduler()
+      : terminate_(false)
+    {
+    }
+
+    JoinScheduler::~JoinScheduler()
+    {
+        Stop();
+    }
+
+    void JoinScheduler::Schedule(std::chrono::milliseconds delay, std::function<void()> join)
+    {
+        {
+            std::lock_guard<std::mutex> _(mutex_);
+            if (terminate_) {
+                return;
+            }
+
+            pending_.emplace(std::chrono::steady_clock::now() + delay, std::move(join));
+            if (!thread_.joinable()) {
+                thread_ = std::thread([this] { SchedulerThread(); });
+            }
+        }
+        cv_.notify_one();
+    }
+
+    void JoinScheduler::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> _(mutex_);
+            terminate_ = true;
+            pending_.clear();
+        }
+        cv_.notify_one();
+
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void JoinScheduler::SchedulerThread()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!terminate_) {
+            if (pending_.empty()) {
+                cv_.wait(lock, [this] { return terminate_ || !pending_.empty(); });
+                continue;
+            }
+
+            const auto due = pending_.begin()->first;
+            if (std::chrono::steady_clock::now() < due) {
+                cv_.wait_until(lock, due);
+                continue;
+            }
+
+            auto join = std::move(pending_.begin()->second);
+            pending_.erase(pending_.begin());
+
+            // Subscribing calls into the transport, which must not be done holding the lock
+            lock.unlock();
+            join();
+            lock.lock();
+        }
+    }
+} // namespace qperf
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "layer_schedule.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+namespace qperf {
+    namespace {
+        /**
+         * @brief Per layer values of a comma separated key, missing entries are the layer's default
+         */
+        template<typename Default>
+        std::vector<std::uint32_t> LayerValues(const ini::IniSection& section,
+                                               const std::string& key,
+                                               std::size_t layers,
+                                               Default default_value)
+        {
+            std::vector<std::uint32_t> values;
+            std::stringstream list(ValueOrDefault<std::string>(section, key, ""));
+            std::string value;
+            while (values.size() < layers && std::getline(list, value, ',')) {
+                try {
+                    values.push_back(static_cast<std::uint32_t>(std::stoul(value)));
+                } catch (const std::exception&) {
+                    SPDLOG_WARN("Invalid {} value '{}' for layer {}. Using default", key, value, values.size());
+                    values.push_back(default_value(values.size()));
+                }
+            }
+
+            while (values.size() < layers) {
+                values.push_back(default_value(values.size()));
+            }
+            return values;
+        }
+    }
+
+    LayerSchedule LayerSchedule::Build(const ini::IniSection& section, const PerfConfig& perf_config)
+    {
+        LayerSchedule schedule;
+
+        auto layers = ValueOrDefault<std::uint32_t>(section, "layers", 1);
+        if (layers <= 1) {
+            return schedule;
+        }
+        if (layers > kMaxLayers) {
+            SPDLOG_WARN("{} layers is more than the maximum {}. Using {}", layers, kMaxLayers, kMaxLayers);
+            layers = kMaxLayers;
+        }
+
+        const auto sizes =
+          LayerValues(section, "layer_object_size", layers, [&](std::size_t) { return perf_config.object_size; });
+        const auto intervals = LayerValues(section, "layer_interval", layers, [](std::size_t) { return 1u; });
+        const auto offsets = LayerValues(section, "layer_offset", layers, [](std::size_t) { return 0u; });
+        const auto priorities = LayerValues(section, "layer_priority", layers, [&](std::size_t layer) {
+            return std::min<std::uint32_t>(perf_config.priority + layer, 255);
+        });
+
+        for (std::size_t layer = 0; layer < layers; ++layer) {
+            LayerConfig config{ sizes[layer],
+                                std::max<std::uint32_t>(intervals[layer], 1),
+                                offsets[layer],
+                                static_cast<std::uint8_t>(std::min<std::uint32_t>(priorities[layer], 255)) };
+            config.offset %= config.interval;
+
+            // Groups start with a base layer object
+            if (layer == 0 && config.offset != 0) {
+                SPDLOG_WARN("The base layer starts the group, ignoring its offset {}", config.offset);
+                config.offset = 0;
+            }
+
+            SPDLOG_INFO("                 layer {} size {} interval {} offset {} pri {}",
+                        layer,
+                        config.object_size,
+                        config.interval,
+                        config.offset,
+                        config.priority);
+            schedule.layers_.push_back(config);
+            schedule.max_size_ = std::max(schedule.max_size_, config.object_size);
+        }
+
+        schedule.layer_objects_.assign(layers, 0);
+        const auto ticks = std::max<std::uint32_t>(perf_config.objects_per_group, 1);
+        std::uint32_t last_tick = 0;
+        for (std::uint32_t tick = 0; tick < ticks; ++tick) {
+            for (std::size_t layer = 0; layer < layers; ++layer) {
+                const auto& config = schedule.layers_[layer];
+                if (tick % config.interval != config.offset) {
+                    continue;
+                }
+
+                if (!schedule.slots_.empty()) {
+                    schedule.slots_.back().ticks_after = tick - last_tick;
+                }
+                schedule.slots_.push_back(
+                  Slot{ static_cast<std::uint8_t>(layer), 0, schedule.layer_objects_[layer]++ });
+                last_tick = tick;
+            }
+        }
+        schedule.slots_.back().ticks_after = ticks - last_tick;
+
+        return schedule;
+    }
+} // namespace qperf
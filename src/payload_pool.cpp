@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "payload_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace qperf {
+    namespace {
+        void FillBasePattern(std::vector<std::uint8_t>& buffer, std::size_t from)
+        {
+            for (std::size_t i = from; i < buffer.size(); i++) {
+                buffer[i] = i % 255;
+            }
+        }
+    }
+
+    PayloadPool::Buffer::Buffer(PayloadPool* pool, std::uint32_t index, std::size_t size)
+      : pool_(pool)
+      , index_(index)
+      , size_(size)
+    {
+    }
+
+    PayloadPool::Buffer::Buffer(Buffer&& other) noexcept
+      : pool_(std::exchange(other.pool_, nullptr))
+      , index_(other.index_)
+      , size_(other.size_)
+    {
+    }
+
+    PayloadPool::Buffer& PayloadPool::Buffer::operator=(Buffer&& other) noexcept
+    {
+        if (this != &other) {
+            if (pool_ != nullptr) {
+                pool_->Release(index_);
+            }
+            pool_ = std::exchange(other.pool_, nullptr);
+            index_ = other.index_;
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    PayloadPool::Buffer::~Buffer()
+    {
+        if (pool_ != nullptr) {
+            pool_->Release(index_);
+        }
+    }
+
+    std::span<std::uint8_t> PayloadPool::Buffer::Span() const noexcept
+    {
+        return { pool_->buffers_[index_].data(), size_ };
+    }
+
+    PayloadPool::PayloadPool(std::size_t buffer_count, std::size_t buffer_size)
+      : buffers_(std::max<std::size_t>(buffer_count, 1))
+      , free_(buffers_.size())
+      , buffer_size_(buffer_size)
+    {
+        for (std::uint32_t i = 0; i < buffers_.size(); ++i) {
+            buffers_[i].resize(buffer_size);
+            FillBasePattern(buffers_[i], 0);
+            free_.TryPush(i);
+        }
+    }
+
+    PayloadPool::Buffer PayloadPool::Acquire(std::size_t size)
+    {
+        std::uint32_t index;
+        if (!free_.TryPop(index)) {
+            exhausted_ += 1;
+            return {};
+        }
+
+        auto& buffer = buffers_[index];
+        if (buffer.size() < size) {
+            oversized_ += 1;
+            const auto old_size = buffer.size();
+            buffer.resize(size);
+            FillBasePattern(buffer, old_size);
+        }
+
+        return { this, index, size };
+    }
+
+    void PayloadPool::Release(std::uint32_t index)
+    {
+        // Not in the free list yet, so the acquiring thread cannot touch it
+        auto& buffer = buffers_[index];
+        if (buffer.size() > buffer_size_) {
+            buffer.resize(buffer_size_);
+            buffer.shrink_to_fit();
+        }
+        free_.TryPush(index);
+    }
+} // namespace qperf
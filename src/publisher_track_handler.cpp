@@ -2,38 +2,144 @@
 // SPDX-License-Identifier: BSD-2-Clause
 
 #include "publisher_track_handler.hpp"
+#include "integrity.hpp"
 #include "qperf.hpp"
+#include "time_source.hpp"
+#include "trace.hpp"
 
 #include <cxxopts.hpp>
 #include <quicr/client.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <string_view>
 #include <thread>
 
 namespace qperf {
-    PerfPublishTrackHandler::PerfPublishTrackHandler(const PerfConfig& perf_config)
+    namespace {
+        std::string_view PublishStatusToString(quicr::PublishTrackHandler::PublishObjectStatus status)
+        {
+            using Status = quicr::PublishTrackHandler::PublishObjectStatus;
+            switch (status) {
+                case Status::kOk:
+                    return "ok";
+                case Status::kInternalError:
+                    return "internal_error";
+                case Status::kNotAuthorized:
+                    return "not_authorized";
+                case Status::kNotAnnounced:
+                    return "not_announced";
+                case Status::kNoSubscribers:
+                    return "no_subscribers";
+                case Status::kObjectPayloadLengthExceeded:
+                    return "payload_length_exceeded";
+                case Status::kPreviousObjectTruncated:
+                    return "previous_object_truncated";
+                case Status::kNoPreviousObject:
+                    return "no_previous_object";
+                case Status::kObjectDataComplete:
+                    return "data_complete";
+                case Status::kObjectContinuationDataNeeded:
+                    return "continuation_data_needed";
+                case Status::kObjectDataIncomplete:
+                    return "data_incomplete";
+                case Status::kObjectDataTooLarge:
+                    return "data_too_large";
+                case Status::kPreviousObjectNotCompleteMustStartNewGroup:
+                    return "must_start_new_group";
+                case Status::kPreviousObjectNotCompleteMustStartNewTrack:
+                    return "must_start_new_track";
+                case Status::kPaused:
+                    return "paused";
+                default:
+                    return "unknown";
+            }
+        }
+    }
+
+    PerfPublishTrackHandler::PerfPublishTrackHandler(const PerfConfig& perf_config,
+                                                     const SizeModelConfig& size_config,
+                                                     const ArrivalConfig& arrival_config,
+                                                     LayerSchedule layer_schedule)
       : PublishTrackHandler(perf_config.full_track_name, perf_config.track_mode, perf_config.priority, perf_config.ttl)
       , perf_config_(perf_config)
+      , size_schedule_(SizeSchedule::Build(size_config, perf_config))
+      , arrival_schedule_(ArrivalSchedule::Build(arrival_config, perf_config))
+      , layer_schedule_(std::move(layer_schedule))
+      , payload_pool_(perf_config.payload_buffers,
+                      std::max({ perf_config.first_object_size,
+                                 perf_config.object_size,
+                                 size_schedule_.TypicalSize(),
+                                 layer_schedule_.MaxSize() }))
       , terminate_(false)
       , last_bytes_(0)
       , test_mode_(qperf::TestMode::kNone)
       , group_id_(0)
       , object_id_(0)
+      , published_object_id_(0)
+      , previous_group_objects_(0)
+      , paused_(false)
+      , pauses_(0)
+      , paused_time_(0)
+      , new_group_requested_us_(0)
 
     {
         memset(&test_metrics_, '\0', sizeof(test_metrics_));
+        memset(&bitrate_metrics_, '\0', sizeof(bitrate_metrics_));
+        publish_status_counts_.fill(0);
+        memset(&wakeup_stats_, '\0', sizeof(wakeup_stats_));
+
+        if (!size_schedule_.Empty()) {
+            std::uint64_t total_size = 0;
+            for (std::size_t i = 0; i < size_schedule_.Length(); ++i) {
+                total_size += size_schedule_.Size(i);
+            }
+
+            // test_name,model,seed,objects,avg_size,max_size
+            SPDLOG_INFO("PO SIZES, {}, {}, {}, {}, {:.1f}, {}",
+                        perf_config_.test_name,
+                        SizeModelToString(size_config.model),
+                        size_config.seed,
+                        size_schedule_.Length(),
+                        double(total_size) / size_schedule_.Length(),
+                        size_schedule_.MaxSize());
+        }
+
+        if (!arrival_schedule_.Empty()) {
+            std::uint64_t total_gap = 0;
+            for (std::size_t i = 0; i < arrival_schedule_.Length(); ++i) {
+                total_gap += arrival_schedule_.Gap(i);
+            }
+
+            // test_name,process,seed,objects,avg_gap_us
+            SPDLOG_INFO("PO ARRIVALS, {}, {}, {}, {}, {:.1f}",
+                        perf_config_.test_name,
+                        ArrivalProcessToString(arrival_config.process),
+                        arrival_config.seed,
+                        arrival_schedule_.Length(),
+                        double(total_gap) / arrival_schedule_.Length());
+        }
     }
 
     std::shared_ptr<PerfPublishTrackHandler> PerfPublishTrackHandler::Create(const std::string& section_name,
                                                                              ini::IniFile& inif,
-                                                                             std::uint32_t instance_id)
+                                                                             std::uint32_t instance_id,
+                                                                             std::uint8_t relay_index)
     {
         PerfConfig perf_config;
         PopulateScenarioFields(section_name, instance_id, inif, perf_config);
-        return std::shared_ptr<PerfPublishTrackHandler>(new PerfPublishTrackHandler(perf_config));
+        perf_config.relay_index = relay_index;
+        SizeModelConfig size_config;
+        PopulateSizeModel(inif[section_name], size_config);
+        ArrivalConfig arrival_config;
+        PopulateArrivalProcess(inif[section_name], arrival_config);
+        // Random arrivals of the same track in different clients must not be identical
+        arrival_config.seed += instance_id;
+        return std::shared_ptr<PerfPublishTrackHandler>(new PerfPublishTrackHandler(
+          perf_config, size_config, arrival_config, LayerSchedule::Build(inif[section_name], perf_config)));
     }
 
     void PerfPublishTrackHandler::StatusChanged(Status status)
@@ -43,7 +149,11 @@ namespace qperf {
                 SPDLOG_INFO("PerfPublishTrackeHandler - status kOk");
                 auto track_alias = GetTrackAlias().value();
                 SPDLOG_INFO("Track alias: {0} is ready to write", track_alias);
-                write_thread_ = SpawnWriter();
+                if (write_thread_.joinable()) {
+                    SetPaused(false);
+                } else {
+                    write_thread_ = SpawnWriter();
+                }
             } break;
             case Status::kNotConnected:
                 SPDLOG_INFO("PerfPublishTrackeHandler - status kNotConnected");
@@ -59,18 +169,24 @@ namespace qperf {
                 break;
             case Status::kNoSubscribers:
                 SPDLOG_INFO("PerfPublishTrackeHandler - status kNoSubscribers");
+                SetPaused(true);
                 break;
             case Status::kSendingUnannounce:
                 SPDLOG_INFO("PerfPublishTrackeHandler - status kSendingUnannounce");
                 break;
             case Status::kPaused:
                 SPDLOG_INFO("PerfPublishTrackeHandler - status kPaused");
+                SetPaused(true);
                 break;
-            case Status::kNewGroupRequested:
+            case Status::kNewGroupRequested: {
                 SPDLOG_INFO("PerfPublishTrackeHandler - status kNewGroupRequested");
-                break;
+                // Keep the earliest pending request, the latency is measured from it
+                std::uint64_t none = 0;
+                new_group_requested_us_.compare_exchange_strong(none, TimeSource::MonotonicNowUs());
+            } break;
             case Status::kSubscriptionUpdated:
                 SPDLOG_INFO("PerfPublishTrackeHandler - status kSubscriptionUpdated");
+                SetPaused(false);
                 break;
             default:
                 SPDLOG_INFO("PerfPublishTrackeHandler - status UNKNOWN");
@@ -80,43 +196,43 @@ namespace qperf {
 
     void PerfPublishTrackHandler::MetricsSampled(const quicr::PublishTrackMetrics& metrics)
     {
-        std::lock_guard<std::mutex> _(mutex_);
-        auto now = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
+        TimeSource::Instance().CheckClockStep();
+        auto now = std::chrono::steady_clock::now();
         if (test_mode_ == qperf::TestMode::kRunning && last_bytes_ != 0) { // skip first metric reporting...
             // calculate bitrate metrics
             auto diff = std::chrono::duration_cast<std::chrono::seconds>(now - last_metric_time_);
             std::uint64_t delta_bytes = metrics.bytes_published - last_bytes_;
-            std::uint64_t bitrate = ((delta_bytes) * 8) / diff.count();
-            test_metrics_.bitrate_total += bitrate;
-            test_metrics_.max_publish_bitrate =
-              bitrate > test_metrics_.max_publish_bitrate ? bitrate : test_metrics_.max_publish_bitrate;
-            test_metrics_.min_publish_bitrate =
-              bitrate < test_metrics_.min_publish_bitrate ? bitrate : test_metrics_.min_publish_bitrate;
-            test_metrics_.metric_samples += 1;
-            test_metrics_.avg_publish_bitrate = test_metrics_.bitrate_total / test_metrics_.metric_samples;
+            std::uint64_t bitrate = ((delta_bytes) * 8) / std::max(diff.count(), std::int64_t(1));
+            bitrate_metrics_.bitrate_total += bitrate;
+            bitrate_metrics_.max_publish_bitrate =
+              bitrate > bitrate_metrics_.max_publish_bitrate ? bitrate : bitrate_metrics_.max_publish_bitrate;
+            bitrate_metrics_.min_publish_bitrate =
+              bitrate < bitrate_metrics_.min_publish_bitrate ? bitrate : bitrate_metrics_.min_publish_bitrate;
+            bitrate_metrics_.metric_samples += 1;
+            bitrate_metrics_.avg_publish_bitrate = bitrate_metrics_.bitrate_total / bitrate_metrics_.metric_samples;
+            bitrate_snapshot_.Store(bitrate_metrics_);
             SPDLOG_INFO("{}: Bitrate: {} {} delta bytes {}, delta time {}, {}, {}, {}",
                         perf_config_.test_name,
                         bitrate,
                         FormatBitrate(bitrate),
                         delta_bytes,
                         diff.count(),
-                        test_metrics_.min_publish_bitrate,
-                        test_metrics_.max_publish_bitrate,
-                        test_metrics_.avg_publish_bitrate);
+                        bitrate_metrics_.min_publish_bitrate,
+                        bitrate_metrics_.max_publish_bitrate,
+                        bitrate_metrics_.avg_publish_bitrate);
         }
 
         last_metric_time_ = now;
         last_bytes_ = metrics.bytes_published;
     }
 
-    std::chrono::time_point<std::chrono::system_clock> PerfPublishTrackHandler::PublishObjectWithMetrics(
-      quicr::BytesSpan object_span)
+    std::uint64_t PerfPublishTrackHandler::PublishObjectWithMetrics(std::span<std::uint8_t> object_span)
     {
-        std::lock_guard<std::mutex> _(mutex_);
-        ObjectTestHeader test_header;
-        memset(&test_header, '\0', sizeof(test_header));
-        if (perf_config_.objects_per_group > 0) {
-            if (!(object_id_ % perf_config_.objects_per_group)) {
+        // A layered group has an object per layer on each of its ticks
+        const auto objects_per_group =
+          layer_schedule_.Empty() ? perf_config_.objects_per_group : layer_schedule_.ObjectsPerGroup();
+        if (objects_per_group > 0) {
+            if (!(object_id_ % objects_per_group)) {
                 object_id_ = 0;
                 group_id_ += 1;
             }
@@ -124,6 +240,25 @@ namespace qperf {
             SPDLOG_WARN("{} Error - objects per groups <= 0", perf_config_.test_name);
         }
 
+        return PublishRunningObject(object_span);
+    }
+
+    std::uint64_t PerfPublishTrackHandler::PublishRunningObject(std::span<std::uint8_t> object_span)
+    {
+        ObjectTestHeader test_header;
+        memset(&test_header, '\0', sizeof(test_header));
+
+        // Groups may end early or vary in length, subscribers account for the previous one with its length
+        if (published_group_id_ != group_id_) {
+            const auto ended_objects = published_object_id_ + 1;
+            previous_group_objects_ =
+              published_group_id_ && *published_group_id_ + 1 == group_id_ && ended_objects <= UINT16_MAX
+                ? static_cast<std::uint16_t>(ended_objects)
+                : 0;
+            published_group_id_ = group_id_;
+        }
+        published_object_id_ = object_id_;
+
         quicr::ObjectHeaders object_headers;
         object_headers.group_id = group_id_;
         object_headers.object_id = object_id_;
@@ -131,27 +266,37 @@ namespace qperf {
         object_headers.priority = perf_config_.priority;
         object_headers.ttl = perf_config_.ttl;
 
+        // Each layer is its own subgroup
+        if (!layer_schedule_.Empty()) {
+            const auto layer = layer_schedule_.At(object_id_).layer;
+            object_headers.subgroup_id = layer;
+            object_headers.priority = layer_schedule_.Layer(layer).priority;
+        }
+
         // get current time..
-        auto now = std::chrono::system_clock::now();
-        auto duration = now.time_since_epoch();
+        const auto now = TimeSource::Instance().EpochNowUs();
 
         // update metrics
         if (test_metrics_.start_transmit_time == 0) {
-            test_metrics_.start_transmit_time = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+            test_metrics_.start_transmit_time = now;
         }
 
         // fill out test_header
         test_header.test_mode = qperf::TestMode::kRunning;
-        test_header.time = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        test_header.relay_index = perf_config_.relay_index;
+        test_header.previous_group_objects = previous_group_objects_;
+        test_header.ttl = perf_config_.ttl;
+        test_header.time = now;
 
         // check how much we can write in the header
         auto header_bytes_to_copy =
           object_span.size() < sizeof(test_header) ? sizeof(test_header.test_mode) : sizeof(test_header);
-        memcpy((void*)object_span.data(), (void*)&test_header, header_bytes_to_copy);
+        memcpy(object_span.data(), &test_header, header_bytes_to_copy);
+        SealObject(perf_config_.integrity, group_id_, object_id_, object_span.data(), object_span.size());
         object_headers.payload_length = object_span.size();
 
         // publish
-        PublishObject(object_headers, object_span);
+        TimedPublishObject(object_headers, object_span);
 
         SPDLOG_TRACE("PO, RUNNING, {}, {}, {}, {}, {}",
                      perf_config_.test_name,
@@ -160,29 +305,35 @@ namespace qperf {
                      publish_track_metrics_.objects_published,
                      publish_track_metrics_.bytes_published);
 
-        // return current time in ms - publish time
+        // return publish time in us
         return now;
     }
 
     std::uint64_t PerfPublishTrackHandler::PublishTestComplete()
     {
-        std::lock_guard<std::mutex> _(mutex_);
         test_mode_ = qperf::TestMode::kComplete;
-        auto now = std::chrono::system_clock::now();
-        auto duration = now.time_since_epoch();
 
         ObjectTestComplete test_complete;
         memset(&test_complete, '\0', sizeof(test_complete));
 
         // start_transmit_time is set when fist object is published
-        test_metrics_.end_transmit_time = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        test_metrics_.end_transmit_time = TimeSource::Instance().EpochNowUs();
 
         // test_metrics_.end_transmit_time;
         test_metrics_.total_published_objects = publish_track_metrics_.objects_published + 1;
         test_metrics_.total_published_bytes = publish_track_metrics_.bytes_published + sizeof(test_complete);
         test_metrics_.total_objects_dropped_not_ok = publish_track_metrics_.objects_dropped_not_ok;
 
-        test_complete.test_mode = test_mode_;
+        const auto bitrate = bitrate_snapshot_.Load();
+        test_metrics_.max_publish_bitrate = bitrate.max_publish_bitrate;
+        test_metrics_.min_publish_bitrate = bitrate.min_publish_bitrate;
+        test_metrics_.avg_publish_bitrate = bitrate.avg_publish_bitrate;
+        test_metrics_.metric_samples = bitrate.metric_samples;
+        test_metrics_.bitrate_total = bitrate.bitrate_total;
+
+        test_complete.test_mode = qperf::TestMode::kComplete;
+        test_complete.relay_index = perf_config_.relay_index;
+        test_complete.ttl = perf_config_.ttl;
         test_complete.time = test_metrics_.end_transmit_time;
         memcpy(&test_complete.test_metrics, &test_metrics_, sizeof(test_metrics_));
 
@@ -199,7 +350,7 @@ namespace qperf {
         object_headers.ttl = perf_config_.ttl;
 
         object_headers.payload_length = sizeof(test_complete);
-        PublishObject(object_headers, object_data);
+        TimedPublishObject(object_headers, object_data);
 
         auto total_transmit_time = test_metrics_.end_transmit_time - test_metrics_.start_transmit_time;
         SPDLOG_INFO("PO, COMPLETE, {}, {}, {}, {}, {}, {}",
@@ -222,28 +373,78 @@ namespace qperf {
         SPDLOG_INFO("                           avg {}", test_metrics_.avg_publish_bitrate);
         SPDLOG_INFO("                               {}",
                     FormatBitrate(static_cast<std::uint32_t>(test_metrics_.avg_publish_bitrate)));
+        SPDLOG_INFO("       Wakeup lateness (us)");
+        SPDLOG_INFO("                           max {}", wakeup_stats_.max_lateness_us);
+        SPDLOG_INFO("                           avg {:.1f}",
+                    wakeup_stats_.samples ? double(wakeup_stats_.total_lateness_us) / wakeup_stats_.samples : 0.0);
+        SPDLOG_INFO("                          late {} of {}", wakeup_stats_.late_wakeups, wakeup_stats_.samples);
         SPDLOG_INFO("--------------------------------------------");
 
+        ReportPublishCalls();
+        ReportSuspensions();
+
         return test_complete.time;
     }
 
-    std::thread PerfPublishTrackHandler::SpawnWriter()
+    PerfPublishTrackHandler::PublishObjectStatus PerfPublishTrackHandler::TimedPublishObject(
+      const quicr::ObjectHeaders& object_headers,
+      quicr::BytesSpan object_span)
     {
-        return std::thread([this] { WriteThread(); });
+        const auto start = std::chrono::steady_clock::now();
+        const auto status = PublishObject(object_headers, object_span);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        publish_call_latency_.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        publish_status_counts_[std::min<std::size_t>(static_cast<std::size_t>(status), kPublishStatusSlots - 1)] += 1;
+
+        if (status != PublishObjectStatus::kOk) {
+            SPDLOG_TRACE("{} PublishObject {}, {} returned {}",
+                         perf_config_.test_name,
+                         object_headers.group_id,
+                         object_headers.object_id,
+                         PublishStatusToString(status));
+        }
+
+        return status;
     }
 
-    void PerfPublishTrackHandler::WriteThread()
+    void PerfPublishTrackHandler::ReportPublishCalls()
     {
-        quicr::Bytes object_0_buffer(perf_config_.first_object_size);
-        quicr::Bytes object_not_0_buffer(perf_config_.object_size);
+        // test_name,calls,p50,p90,p99,p99.9,max publish call latency (ns),objects_dropped_not_ok,
+        //       payload_pool_exhausted,payload_pool_oversized
+        SPDLOG_INFO("PO CALLS, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+                    perf_config_.test_name,
+                    publish_call_latency_.Count(),
+                    publish_call_latency_.Percentile(50),
+                    publish_call_latency_.Percentile(90),
+                    publish_call_latency_.Percentile(99),
+                    publish_call_latency_.Percentile(99.9),
+                    publish_call_latency_.Max(),
+                    publish_track_metrics_.objects_dropped_not_ok,
+                    payload_pool_.Exhausted(),
+                    payload_pool_.Oversized());
+
+        for (std::size_t i = 0; i < publish_status_counts_.size(); ++i) {
+            if (publish_status_counts_[i] == 0) {
+                continue;
+            }
 
-        for (std::size_t i = 0; i < object_0_buffer.size(); i++) {
-            object_0_buffer[i] = i % 255;
+            // test_name,status,count
+            SPDLOG_INFO("PO STATUS, {}, {}, {}",
+                        perf_config_.test_name,
+                        PublishStatusToString(static_cast<PublishObjectStatus>(i)),
+                        publish_status_counts_[i]);
         }
+    }
 
-        for (std::size_t i = 0; i < object_not_0_buffer.size(); i++) {
-            object_not_0_buffer[i] = i % 255;
-        }
+    std::thread PerfPublishTrackHandler::SpawnWriter()
+    {
+        return std::thread([this] { WriteThread(); });
+    }
+
+    void PerfPublishTrackHandler::WriteThread()
+    {
+        std::uint64_t object_index = 0;
 
         group_id_ = 0;
         object_id_ = 0;
@@ -253,39 +454,104 @@ namespace qperf {
             return;
         }
 
-        const std::chrono::time_point<std::chrono::system_clock> start_transmit_time = std::chrono::system_clock::now();
-        auto transmit_time_ms = std::chrono::milliseconds(perf_config_.total_test_time);
-        auto end_transmit_time = start_transmit_time + transmit_time_ms;
+        const auto end_transmit_time = TimeSource::Instance().EpochNowUs() + perf_config_.total_test_time * 1000;
+        const auto end_transmit_deadline =
+          std::chrono::steady_clock::now() + std::chrono::milliseconds(perf_config_.total_test_time);
 
         // Delay before transmitting
         if (perf_config_.start_delay > 0) {
             std::this_thread::sleep_for(std::chrono::milliseconds(33));
             test_mode_ = qperf::TestMode::kWaitPreTest;
             SPDLOG_INFO("{} Waiting start delay {} ms", perf_config_.test_name, perf_config_.start_delay);
-            const std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
+            const auto start = std::chrono::steady_clock::now();
             auto delay_ms = std::chrono::milliseconds(perf_config_.start_delay);
             auto end_time = start + delay_ms;
             while (!terminate_) {
-                auto now = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
-                if (now >= end_time) {
+                if (std::chrono::steady_clock::now() >= end_time) {
                     break;
                 }
                 std::this_thread::sleep_for(std::chrono::microseconds(500));
             }
         }
 
+        if (!perf_config_.trace_file.empty()) {
+            ReplayTrace();
+            return;
+        }
+
         // Transmit
         SPDLOG_INFO("{} Start transmitting for {} ms", perf_config_.test_name, perf_config_.total_transmit_time);
 
+        if (perf_config_.transmit_interval < 0) {
+            SPDLOG_WARN("{} Transmit interval is < 0", perf_config_.test_name);
+        }
+
+        // Deadline based pacing, a slow publish or late wake-up does not push out the rest of the schedule
+        const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double, std::milli>(std::max(perf_config_.transmit_interval, 0.0)));
+        auto next_publish_time = std::chrono::steady_clock::now();
+        std::uint64_t arrival_index = 0;
+
+        // Synchronized bursts start on the same wall clock boundary in every client
+        if (!arrival_schedule_.Empty()) {
+            next_publish_time +=
+              std::chrono::microseconds(arrival_schedule_.StartDelay(TimeSource::Instance().EpochNowUs()));
+            std::this_thread::sleep_until(next_publish_time);
+        }
+
         test_mode_ = qperf::TestMode::kRunning;
         while (!terminate_) {
-            std::chrono::time_point<std::chrono::system_clock> last_publish_time;
-            if (object_id_ == 0) {
-                quicr::BytesSpan object_span(object_0_buffer);
-                last_publish_time = PublishObjectWithMetrics(object_span);
+            // Nothing is published while suspended, the schedule restarts from the resume time. Synchronized
+            // bursts restart with a whole burst on the next wall clock boundary
+            if (paused_) {
+                WaitWhilePaused(end_transmit_deadline);
+                next_publish_time = std::chrono::steady_clock::now();
+                if (next_publish_time < end_transmit_deadline) {
+                    if (!arrival_schedule_.Empty()) {
+                        arrival_index = arrival_schedule_.NextAlignedIndex(arrival_index);
+                        next_publish_time +=
+                          std::chrono::microseconds(arrival_schedule_.StartDelay(TimeSource::Instance().EpochNowUs()));
+                        std::this_thread::sleep_until(next_publish_time);
+                    }
+                    continue;
+                }
+            }
+
+            // Start the next group right away, PublishObjectWithMetrics rolls over on object 0. The size
+            // schedule moves on to its next group start so the forced group opens with a keyframe size
+            const auto new_group_requested_us = new_group_requested_us_.exchange(0);
+            if (new_group_requested_us != 0) {
+                object_id_ = 0;
+                if (perf_config_.objects_per_group > 0) {
+                    const auto into_group = object_index % perf_config_.objects_per_group;
+                    object_index += into_group ? perf_config_.objects_per_group - into_group : 0;
+                }
+            }
+
+            std::size_t object_size = perf_config_.object_size;
+            std::uint32_t ticks_after = 1;
+            if (!layer_schedule_.Empty()) {
+                const auto& slot = layer_schedule_.At(object_id_);
+                ticks_after = slot.ticks_after;
+                object_size = object_id_ % layer_schedule_.ObjectsPerGroup() == 0
+                                ? perf_config_.first_object_size
+                                : layer_schedule_.Layer(slot.layer).object_size;
+            } else if (!size_schedule_.Empty()) {
+                object_size = size_schedule_.Size(object_index++);
+            } else if (object_id_ == 0) {
+                object_size = perf_config_.first_object_size;
+            }
+
+            // The buffer returns to the pool once published, the transport copies what it queues
+            std::uint64_t last_publish_time;
+            if (auto buffer = payload_pool_.Acquire(object_size)) {
+                last_publish_time = PublishObjectWithMetrics(buffer.Span());
             } else {
-                quicr::BytesSpan object_span(object_not_0_buffer);
-                last_publish_time = PublishObjectWithMetrics(object_span);
+                last_publish_time = TimeSource::Instance().EpochNowUs();
+            }
+
+            if (new_group_requested_us != 0) {
+                new_group_latency_.Record(TimeSource::MonotonicNowUs() - new_group_requested_us);
             }
 
             // Check if we are done...
@@ -298,21 +564,179 @@ namespace qperf {
                 return;
             }
 
-            // Wait interval
-            if (perf_config_.transmit_interval >= 0) {
-                std::uint64_t interval_us = (perf_config_.transmit_interval * 1000.0f);
-                std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
-            } else {
-                SPDLOG_WARN("{} Transmit interval is < 0", perf_config_.test_name);
+            // The layers of a tick are published back to back
+            if (ticks_after == 0) {
+                object_id_ += 1;
+                continue;
             }
+
+            // Wait for the next scheduled publish, layered tracks skip the ticks without an object
+            const auto scheduled_publish_time = next_publish_time;
+            for (std::uint32_t tick = 0; tick < ticks_after; ++tick) {
+                if (arrival_schedule_.Empty()) {
+                    next_publish_time += interval;
+                } else {
+                    next_publish_time += std::chrono::microseconds(arrival_schedule_.Gap(arrival_index++));
+                }
+            }
+            std::this_thread::sleep_until(next_publish_time);
+            RecordWakeup(std::chrono::steady_clock::now() - next_publish_time,
+                         next_publish_time - scheduled_publish_time);
+
             object_id_ += 1;
         };
         SPDLOG_WARN("{} Exiting writer thread.", perf_config_.test_name);
     }
 
+    void PerfPublishTrackHandler::ReplayTrace()
+    {
+        TraceReader reader;
+        if (!reader.Open(perf_config_.trace_file)) {
+            SPDLOG_ERROR(
+              "{} Unable to replay trace {} - stopping test", perf_config_.test_name, perf_config_.trace_file);
+            terminate_ = true;
+            return;
+        }
+
+        SPDLOG_INFO("{} Start replaying {} objects of trace {} ({})",
+                    perf_config_.test_name,
+                    reader.Count(),
+                    perf_config_.trace_file,
+                    reader.Header().track_name);
+
+        // Absolute pacing, every object is scheduled at its trace offset from the replay start
+        const auto start_time = std::chrono::steady_clock::now();
+        auto last_publish_time = start_time;
+
+        test_mode_ = qperf::TestMode::kRunning;
+
+        // Groups whose length subscribers cannot assume from objects_per_group
+        std::uint64_t groups = 0;
+        std::uint64_t variable_groups = 0;
+        std::uint64_t last_group_id = 0;
+        std::uint64_t last_object_id = 0;
+
+        TraceRecord record;
+        while (!terminate_ && reader.Next(record)) {
+            if (groups == 0 || record.group_id != last_group_id) {
+                if (groups > 0 && last_object_id + 1 != perf_config_.objects_per_group) {
+                    variable_groups += 1;
+                    if (last_object_id >= UINT16_MAX) {
+                        SPDLOG_WARN("{} Trace group {} has {} objects, too long for subscribers to account",
+                                    perf_config_.test_name,
+                                    last_group_id,
+                                    last_object_id + 1);
+                    }
+                }
+                groups += 1;
+                last_group_id = record.group_id;
+            }
+            last_object_id = record.object_id;
+
+            const auto publish_time = start_time + std::chrono::microseconds(record.offset_us);
+            std::this_thread::sleep_until(publish_time);
+            if (publish_time > last_publish_time) {
+                RecordWakeup(std::chrono::steady_clock::now() - publish_time, publish_time - last_publish_time);
+                last_publish_time = publish_time;
+            }
+
+            // The trace decides the groups, new group requests are not honored during replay
+            if (paused_) {
+                continue;
+            }
+
+            group_id_ = record.group_id;
+            object_id_ = record.object_id;
+            if (auto buffer = payload_pool_.Acquire(record.size)) {
+                PublishRunningObject(buffer.Span());
+            }
+        }
+
+        if (variable_groups > 0) {
+            SPDLOG_INFO("{} Replayed {} groups, {} of them not {} objects long",
+                        perf_config_.test_name,
+                        groups,
+                        variable_groups,
+                        perf_config_.objects_per_group);
+        }
+
+        if (terminate_) {
+            SPDLOG_WARN("{} Exiting writer thread during replay.", perf_config_.test_name);
+            return;
+        }
+
+        // publish COMPLETE object - end of test
+        std::this_thread::sleep_for(std::chrono::milliseconds(33));
+        PublishTestComplete();
+        std::this_thread::sleep_for(std::chrono::milliseconds(perf_config_.start_delay / 2));
+        terminate_ = true;
+    }
+
+    void PerfPublishTrackHandler::RecordWakeup(std::chrono::steady_clock::duration lateness,
+                                               std::chrono::steady_clock::duration gap)
+    {
+        const auto lateness_us = static_cast<std::uint64_t>(
+          std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(lateness).count(), 0));
+
+        wakeup_stats_.samples += 1;
+        wakeup_stats_.total_lateness_us += lateness_us;
+        wakeup_stats_.max_lateness_us = std::max(wakeup_stats_.max_lateness_us, lateness_us);
+        // Late against the gap this wake-up waited for, back to back publishes of a burst are never late
+        if (gap.count() > 0 && lateness > gap / 2) {
+            wakeup_stats_.late_wakeups += 1;
+        }
+    }
+
+    void PerfPublishTrackHandler::SetPaused(bool paused)
+    {
+        {
+            std::lock_guard<std::mutex> _(pause_mutex_);
+            paused_ = paused;
+        }
+        pause_cv_.notify_all();
+    }
+
+    void PerfPublishTrackHandler::WaitWhilePaused(std::chrono::steady_clock::time_point deadline)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        SPDLOG_INFO("{} Suspending writer", perf_config_.test_name);
+
+        std::unique_lock<std::mutex> lock(pause_mutex_);
+        pause_cv_.wait_until(lock, deadline, [this] { return !paused_ || terminate_; });
+
+        const auto paused_time = std::chrono::steady_clock::now() - start;
+        pauses_ += 1;
+        paused_time_ += paused_time;
+        SPDLOG_INFO("{} Resuming writer after {} ms",
+                    perf_config_.test_name,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(paused_time).count());
+    }
+
+    void PerfPublishTrackHandler::ReportSuspensions()
+    {
+        // test_name,pauses,paused_ms
+        SPDLOG_INFO("PO PAUSE, {}, {}, {}",
+                    perf_config_.test_name,
+                    pauses_,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(paused_time_).count());
+
+        // test_name,requests,p50,p99,max new group request to first object of the group (us)
+        SPDLOG_INFO("PO NEW GROUP, {}, {}, {}, {}, {}",
+                    perf_config_.test_name,
+                    new_group_latency_.Count(),
+                    new_group_latency_.Percentile(50),
+                    new_group_latency_.Percentile(99),
+                    new_group_latency_.Max());
+    }
+
     void PerfPublishTrackHandler::StopWriter()
     {
         terminate_ = true;
+        {
+            // Wake a suspended writer, taking the lock so the wakeup cannot slip past its predicate check
+            std::lock_guard<std::mutex> _(pause_mutex_);
+        }
+        pause_cv_.notify_all();
         if (write_thread_.joinable()) {
             write_thread_.join();
         }
@@ -0,0 +1,404 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "async_log_sink.hpp"
+#include "control_track_handler.hpp"
+#include "histogram.hpp"
+#include "qperf.hpp"
+#include "self_profiler.hpp"
+#include "time_source.hpp"
+
+#include <cxxopts.hpp>
+#include <quicr/client.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace qperf;
+
+std::atomic_bool terminate = false;
+
+void
+HandleTerminateSignal(int)
+{
+    terminate = true;
+}
+
+class PerfCtrlClient : public quicr::Client
+{
+  public:
+    explicit PerfCtrlClient(const quicr::ClientConfig& cfg)
+      : quicr::Client(cfg)
+    {
+    }
+
+    void StatusChanged(Status status) override
+    {
+        switch (status) {
+            case Status::kReady:
+                SPDLOG_INFO("Client status - kReady");
+                ready_ = true;
+                break;
+            case Status::kNotReady:
+                SPDLOG_INFO("Client status - kNotReady");
+                break;
+            case Status::kConnecting:
+                SPDLOG_INFO("Client status - kConnecting");
+                break;
+            case Status::kNotConnected:
+                SPDLOG_INFO("Client status - kNotConnected");
+                break;
+            case Status::kPendingServerSetup:
+                SPDLOG_INFO("Client status - kPendingSeverSetup");
+                break;
+
+            case Status::kFailedToConnect:
+                SPDLOG_ERROR("Client status - kFailedToConnect");
+                terminate_ = true;
+                break;
+            case Status::kInternalError:
+                SPDLOG_ERROR("Client status - kInternalError");
+                terminate_ = true;
+                break;
+            case Status::kInvalidParams:
+                SPDLOG_ERROR("Client status - kInvalidParams");
+                terminate_ = true;
+                break;
+            default:
+                SPDLOG_ERROR("Connection failed {0}", static_cast<int>(status));
+                terminate_ = true;
+                break;
+        }
+    }
+
+    void MetricsSampled(const quicr::ConnectionMetrics&) override {}
+
+    bool IsReady() const noexcept { return ready_; }
+    bool GetTerminateStatus() const noexcept { return terminate_; }
+
+    ControlTiming& Announce(const quicr::FullTrackName& full_track_name)
+    {
+        auto handler = pub_track_handlers_.emplace_back(std::make_shared<ControlPublishTrackHandler>(full_track_name));
+        handler->Timing().Start();
+        PublishTrack(handler);
+        return handler->Timing();
+    }
+
+    ControlTiming& Subscribe(const quicr::FullTrackName& full_track_name)
+    {
+        auto handler =
+          sub_track_handlers_.emplace_back(std::make_shared<ControlSubscribeTrackHandler>(full_track_name));
+        handler->Timing().Start();
+        SubscribeTrack(handler);
+        return handler->Timing();
+    }
+
+    ClientLoad GetLoad() const
+    {
+        ClientLoad load;
+        memset(&load, '\0', sizeof(load));
+        load.objects = pub_track_handlers_.size() + sub_track_handlers_.size();
+        return load;
+    }
+
+    void Terminate()
+    {
+        for (auto handler : sub_track_handlers_) {
+            UnsubscribeTrack(handler);
+        }
+
+        for (auto handler : pub_track_handlers_) {
+            UnpublishTrack(handler);
+        }
+
+        terminate_ = true;
+    }
+
+  private:
+    std::atomic_bool ready_{ false };
+    std::atomic_bool terminate_{ false };
+
+    // Only used by the main thread
+    std::vector<std::shared_ptr<ControlPublishTrackHandler>> pub_track_handlers_;
+    std::vector<std::shared_ptr<ControlSubscribeTrackHandler>> sub_track_handlers_;
+};
+
+/**
+ * @brief Namespace of the index'th namespace, depth / delimited levels below the prefix
+ * @details Each level above the leaf groups fanout times more namespaces than the level below it, so the
+ *          hierarchy shares prefixes the way nested rooms or tenants would.
+ */
+std::string
+MakeControlNamespace(const std::string& prefix, std::uint64_t index, std::uint32_t depth, std::uint32_t fanout)
+{
+    std::string name_space = prefix;
+    for (std::uint32_t level = 1; level <= depth; ++level) {
+        std::uint64_t divisor = 1;
+        for (std::uint32_t i = level; i < depth; ++i) {
+            divisor *= fanout;
+        }
+        name_space += "/" + std::to_string(index / divisor);
+    }
+    return name_space;
+}
+
+/**
+ * @brief Issue count control operations in batches and log the response latency of each batch
+ * @details A batch is issued back to back, then the responses are awaited for up to timeout before the
+ *          next batch. The latency of later batches against the first shows how the relay slows down
+ *          as its state grows.
+ */
+void
+RunPhase(const std::string& phase,
+         std::size_t count,
+         std::size_t batch_size,
+         std::chrono::milliseconds timeout,
+         const std::function<ControlTiming&(std::size_t)>& issue,
+         const std::function<bool()>& stopped)
+{
+    Histogram phase_latency;
+    std::uint64_t ok = 0;
+    std::uint64_t failed = 0;
+    std::uint64_t timed_out = 0;
+    std::uint64_t phase_time_us = 0;
+    std::uint64_t first_p50 = 0;
+    std::uint64_t last_p50 = 0;
+
+    std::vector<ControlTiming*> batch;
+    batch.reserve(batch_size);
+
+    std::size_t batch_index = 0;
+    for (std::size_t next = 0; next < count && !stopped(); ++batch_index) {
+        batch.clear();
+        const auto batch_start = TimeSource::MonotonicNowUs();
+        for (; next < count && batch.size() < batch_size; ++next) {
+            batch.push_back(&issue(next));
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!stopped() && std::chrono::steady_clock::now() < deadline &&
+               std::any_of(batch.begin(), batch.end(), [](const ControlTiming* timing) {
+                   return timing->Result() == ControlResult::kPending;
+               })) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        Histogram batch_latency;
+        std::uint64_t batch_ok = 0;
+        std::uint64_t batch_failed = 0;
+        std::uint64_t batch_end = batch_start;
+        for (const auto* timing : batch) {
+            switch (timing->Result()) {
+                case ControlResult::kOk:
+                    batch_ok += 1;
+                    batch_latency.Record(timing->Latency());
+                    batch_end = std::max(batch_end, timing->ResponseTime());
+                    break;
+                case ControlResult::kFailed:
+                    batch_failed += 1;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        const auto batch_timed_out = batch.size() - batch_ok - batch_failed;
+        const auto batch_time_us = batch_end - batch_start;
+        const auto ops_per_sec = batch_time_us ? batch_ok * 1'000'000 / batch_time_us : 0;
+
+        ok += batch_ok;
+        failed += batch_failed;
+        timed_out += batch_timed_out;
+        phase_time_us += batch_time_us;
+        phase_latency.Merge(batch_latency);
+        if (batch_index == 0) {
+            first_p50 = batch_latency.Percentile(50);
+        }
+        last_p50 = batch_latency.Percentile(50);
+
+        // phase,batch,issued,ok,failed,timed_out,p50,p90,p99,max (us),ops_per_sec
+        SPDLOG_INFO("CTRL BATCH, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+                    phase,
+                    batch_index,
+                    batch.size(),
+                    batch_ok,
+                    batch_failed,
+                    batch_timed_out,
+                    batch_latency.Percentile(50),
+                    batch_latency.Percentile(90),
+                    batch_latency.Percentile(99),
+                    batch_latency.Max(),
+                    ops_per_sec);
+    }
+
+    const auto ops_per_sec = phase_time_us ? ok * 1'000'000 / phase_time_us : 0;
+    const auto latency_growth = first_p50 ? static_cast<double>(last_p50) / static_cast<double>(first_p50) : 0.0;
+
+    // phase,count,ok,failed,timed_out,p50,p90,p99,max (us),ops_per_sec,latency_growth
+    SPDLOG_INFO("CTRL COMPLETE, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {:.2f}",
+                phase,
+                count,
+                ok,
+                failed,
+                timed_out,
+                phase_latency.Percentile(50),
+                phase_latency.Percentile(90),
+                phase_latency.Percentile(99),
+                phase_latency.Max(),
+                ops_per_sec,
+                latency_growth);
+}
+
+int
+main(int argc, char** argv)
+{
+    // clang-format off
+    cxxopts::Options options("QPerf");
+    options.add_options()
+        ("endpoint_id",     "Name of the client",                                    cxxopts::value<std::string>()->default_value("perf@cisco.com"))
+        ("connect_uri",     "Relay to connect to",                                   cxxopts::value<std::string>()->default_value("moq://localhost:1234"))
+        ("i,test_id",       "Test idenfiter number",                                 cxxopts::value<std::uint32_t>()->default_value("1"))
+        ("mode",            "Control operations (announce|subscribe|both)",          cxxopts::value<std::string>()->default_value("both"))
+        ("namespace",       "Namespace prefix, {} is the test id",                   cxxopts::value<std::string>()->default_value("perf/ctrl/{}"))
+        ("n,namespaces",    "Number of namespaces",                                  cxxopts::value<std::uint64_t>()->default_value("1000"))
+        ("depth",           "Namespace levels below the prefix",                     cxxopts::value<std::uint32_t>()->default_value("1"))
+        ("fanout",          "Namespaces per level of the hierarchy",                 cxxopts::value<std::uint32_t>()->default_value("10"))
+        ("tracks",          "Tracks per namespace",                                  cxxopts::value<std::uint32_t>()->default_value("1"))
+        ("batch",           "Operations issued before awaiting responses",           cxxopts::value<std::uint32_t>()->default_value("1000"))
+        ("timeout",         "Response timeout per batch (ms)",                       cxxopts::value<std::uint32_t>()->default_value("5000"))
+        ("profile_ms",      "Self profile interval (ms)",                            cxxopts::value<std::uint32_t>()->default_value("1000"))
+        ("saturation",      "CPU % marking client saturated",                        cxxopts::value<double>()->default_value("90"))
+        ("h,help",          "Print usage");
+    // clang-format on
+
+    cxxopts::ParseResult result;
+
+    try {
+        result = options.parse(argc, argv);
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Caught exception while parsing arguments: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (result.count("help")) {
+        std::cerr << options.help() << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    const auto mode = result["mode"].as<std::string>();
+    if (mode != "announce" && mode != "subscribe" && mode != "both") {
+        std::cerr << "Invalid mode '" << mode << "', expected announce, subscribe or both" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    quicr::TransportConfig config;
+    config.tls_cert_filename = "";
+    config.tls_key_filename = "";
+    config.time_queue_max_duration = 5000;
+    config.use_reset_wait_strategy = false;
+    config.quic_qlog_path = "";
+
+    const auto test_identifier = result["test_id"].as<std::uint32_t>();
+    auto endpoint_test_id = result["endpoint_id"].as<std::string>() + ":" + std::to_string(test_identifier);
+
+    quicr::ClientConfig client_config;
+    client_config.connect_uri = result["connect_uri"].as<std::string>();
+    client_config.endpoint_id = endpoint_test_id;
+    client_config.metrics_sample_ms = 5000;
+    client_config.transport_config = config;
+    client_config.tick_service_sleep_delay_us = 50'000;
+
+    const auto logger = CreateAsyncLogger(endpoint_test_id);
+
+    const auto prefix =
+      fmt::vformat(result["namespace"].as<std::string>(), fmt::make_format_args(test_identifier));
+    const auto namespaces = result["namespaces"].as<std::uint64_t>();
+    const auto depth = std::max<std::uint32_t>(result["depth"].as<std::uint32_t>(), 1);
+    const auto fanout = std::max<std::uint32_t>(result["fanout"].as<std::uint32_t>(), 2);
+    const auto tracks = std::max<std::uint32_t>(result["tracks"].as<std::uint32_t>(), 1);
+    const auto batch_size = std::max<std::uint32_t>(result["batch"].as<std::uint32_t>(), 1);
+    const auto timeout = std::chrono::milliseconds(result["timeout"].as<std::uint32_t>());
+
+    SPDLOG_INFO("--------------------------------------------");
+    SPDLOG_INFO("Control plane test:");
+    SPDLOG_INFO("                    mode {}", mode);
+    SPDLOG_INFO("               namespace {}", MakeControlNamespace(prefix, namespaces - 1, depth, fanout));
+    SPDLOG_INFO("              namespaces {}", namespaces);
+    SPDLOG_INFO("    tracks per namespace {}", tracks);
+    SPDLOG_INFO("                   batch {}", batch_size);
+    SPDLOG_INFO("--------------------------------------------");
+
+    std::signal(SIGINT, HandleTerminateSignal);
+
+    auto client = std::make_shared<PerfCtrlClient>(client_config);
+
+    SelfProfiler profiler(std::chrono::milliseconds(result["profile_ms"].as<std::uint32_t>()),
+                          result["saturation"].as<double>());
+    profiler.Start();
+
+    try {
+        client->Connect();
+    } catch (const std::exception& e) {
+        SPDLOG_LOGGER_CRITICAL(
+          logger, "Failed to connect to relay '{0}' with exception: {1}", client_config.connect_uri, e.what());
+        return EXIT_FAILURE;
+    } catch (...) {
+        SPDLOG_LOGGER_CRITICAL(logger, "Unexpected error connecting to relay");
+        return EXIT_FAILURE;
+    }
+
+    while (!terminate && !client->GetTerminateStatus() && !client->IsReady()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    const auto stopped = [&client] { return terminate || client->GetTerminateStatus(); };
+    const auto full_track_name = [&](std::size_t index) {
+        return MakeFullTrackName(MakeControlNamespace(prefix, index / tracks, depth, fanout),
+                                 "t" + std::to_string(index % tracks));
+    };
+    const std::size_t count = namespaces * tracks;
+
+    if (mode != "subscribe") {
+        RunPhase(
+          "announce",
+          count,
+          batch_size,
+          timeout,
+          [&](std::size_t index) -> ControlTiming& { return client->Announce(full_track_name(index)); },
+          stopped);
+    }
+
+    if (mode != "announce") {
+        RunPhase(
+          "subscribe",
+          count,
+          batch_size,
+          timeout,
+          [&](std::size_t index) -> ControlTiming& { return client->Subscribe(full_track_name(index)); },
+          stopped);
+    }
+
+    // An announcing client keeps its namespaces until stopped, so subscribers in other processes find them
+    while (mode == "announce" && !stopped()) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    client->Terminate();
+    client->Disconnect();
+
+    profiler.Report(endpoint_test_id, client->GetLoad());
+    profiler.Stop();
+
+    ReportAsyncLogger(endpoint_test_id);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,244 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "async_log_sink.hpp"
+#include "fetch_track_handler.hpp"
+#include "join_scheduler.hpp"
+#include "self_profiler.hpp"
+
+#include <cxxopts.hpp>
+#include <quicr/client.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PerfFetchClient : public quicr::Client
+{
+  public:
+    PerfFetchClient(const quicr::ClientConfig& cfg,
+                    const std::string& configfile,
+                    std::uint32_t test_identifier,
+                    std::uint32_t fetches)
+      : quicr::Client(cfg)
+      , configfile_(configfile)
+      , test_identifier_(test_identifier)
+      , fetches_(fetches)
+    {
+    }
+
+    void StatusChanged(Status status) override
+    {
+        switch (status) {
+            case Status::kReady: {
+                SPDLOG_INFO("Client status - kReady");
+                std::lock_guard<std::mutex> _(track_handlers_mutex_);
+                inif_.load(configfile_);
+                for (const auto& section_pair : inif_) {
+                    const std::string& section_name = section_pair.first;
+                    for (std::uint32_t i = 0; i < fetches_; ++i) {
+                        auto fetch_handler = track_handlers_.emplace_back(
+                          qperf::PerfFetchTrackHandler::Create(section_name, inif_, test_identifier_, i));
+
+                        // All fetches of a track are sent together to load the relay cache concurrently
+                        fetch_scheduler_.Schedule(fetch_handler->Delay(), [this, fetch_handler] {
+                            fetch_handler->Fetching();
+                            FetchTrack(fetch_handler);
+                        });
+                    }
+                    SPDLOG_INFO("Fetching {} {} times in {} ms",
+                                section_name,
+                                fetches_,
+                                track_handlers_.back()->Delay().count());
+                }
+            } break;
+            case Status::kNotReady:
+                SPDLOG_INFO("Client status - kNotReady");
+                break;
+            case Status::kConnecting:
+                SPDLOG_INFO("Client status - kConnecting");
+                break;
+            case Status::kNotConnected:
+                SPDLOG_INFO("Client status - kNotConnected");
+                break;
+            case Status::kPendingServerSetup:
+                SPDLOG_INFO("Client status - kPendingSeverSetup");
+                break;
+
+            case Status::kFailedToConnect:
+                SPDLOG_ERROR("Client status - kFailedToConnect");
+                terminate_ = true;
+                break;
+            case Status::kInternalError:
+                SPDLOG_ERROR("Client status - kInternalError");
+                terminate_ = true;
+                break;
+            case Status::kInvalidParams:
+                SPDLOG_ERROR("Client status - kInvalidParams");
+                terminate_ = true;
+                break;
+            default:
+                SPDLOG_ERROR("Connection failed {0}", static_cast<int>(status));
+                terminate_ = true;
+                break;
+        }
+    }
+
+    void MetricsSampled(const quicr::ConnectionMetrics&) override {}
+
+    bool GetTerminateStatus() { return terminate_; }
+
+    bool HandlersComplete()
+    {
+        std::lock_guard<std::mutex> _(track_handlers_mutex_);
+        if (track_handlers_.empty()) {
+            return false;
+        }
+
+        bool complete = true;
+        for (auto handler : track_handlers_) {
+            if (handler->CheckComplete()) {
+                handler->Report();
+            } else {
+                complete = false;
+            }
+        }
+        return complete;
+    }
+
+    qperf::ClientLoad GetLoad()
+    {
+        std::lock_guard<std::mutex> _(track_handlers_mutex_);
+        qperf::ClientLoad load;
+        memset(&load, '\0', sizeof(load));
+        for (auto handler : track_handlers_) {
+            load.objects += handler->TotalObjects();
+        }
+        return load;
+    }
+
+    void Terminate()
+    {
+        fetch_scheduler_.Stop();
+        std::lock_guard<std::mutex> _(track_handlers_mutex_);
+        for (auto handler : track_handlers_) {
+            if (!handler->IsComplete()) {
+                SPDLOG_INFO("cancel fetch {}", handler->TestName());
+                CancelFetchTrack(handler);
+            }
+            handler->Report();
+        }
+        terminate_ = true;
+    }
+
+  private:
+    std::atomic_bool terminate_{ false };
+    std::string configfile_;
+    ini::IniFile inif_;
+    std::uint32_t test_identifier_;
+    std::uint32_t fetches_;
+
+    std::vector<std::shared_ptr<qperf::PerfFetchTrackHandler>> track_handlers_;
+    std::mutex track_handlers_mutex_;
+    qperf::JoinScheduler fetch_scheduler_;
+};
+
+std::atomic_bool terminate = false;
+
+void
+HandleTerminateSignal(int)
+{
+    terminate = true;
+}
+
+int
+main(int argc, char** argv)
+{
+    // clang-format off
+    cxxopts::Options options("QPerf");
+    options.add_options()
+        ("endpoint_id",     "Name of the client",                                    cxxopts::value<std::string>()->default_value("perf@cisco.com"))
+        ("connect_uri",     "Relay to connect to",                                   cxxopts::value<std::string>()->default_value("moq://localhost:1234"))
+        ("i,test_id",       "Test idenfiter number",                                 cxxopts::value<std::uint32_t>()->default_value("1"))
+        ("c,config",        "Scenario config file",                                  cxxopts::value<std::string>())
+        ("n,fetches",       "Concurrent fetches per track",                          cxxopts::value<std::uint32_t>()->default_value("1"))
+        ("profile_ms",      "Self profile interval (ms)",                            cxxopts::value<std::uint32_t>()->default_value("1000"))
+        ("saturation",      "CPU % marking client saturated",                        cxxopts::value<double>()->default_value("90"))
+        ("h,help",          "Print usage");
+    // clang-format on
+
+    cxxopts::ParseResult result;
+
+    try {
+        result = options.parse(argc, argv);
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Caught exception while parsing arguments: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (result.count("help")) {
+        std::cerr << options.help() << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    quicr::TransportConfig config;
+    config.tls_cert_filename = "";
+    config.tls_key_filename = "";
+    config.time_queue_max_duration = 5000;
+    config.use_reset_wait_strategy = false;
+    config.quic_qlog_path = "";
+
+    auto endpoint_test_id =
+      result["endpoint_id"].as<std::string>() + ":" + std::to_string(result["test_id"].as<std::uint32_t>());
+
+    quicr::ClientConfig client_config;
+    client_config.connect_uri = result["connect_uri"].as<std::string>();
+    client_config.endpoint_id = endpoint_test_id;
+    client_config.metrics_sample_ms = 5000;
+    client_config.transport_config = config;
+    client_config.tick_service_sleep_delay_us = 50'000;
+
+    const auto logger = qperf::CreateAsyncLogger(endpoint_test_id);
+
+    auto client = std::make_shared<PerfFetchClient>(client_config,
+                                                    result["config"].as<std::string>(),
+                                                    result["test_id"].as<std::uint32_t>(),
+                                                    std::max<std::uint32_t>(result["fetches"].as<std::uint32_t>(), 1));
+
+    std::signal(SIGINT, HandleTerminateSignal);
+
+    qperf::SelfProfiler profiler(std::chrono::milliseconds(result["profile_ms"].as<std::uint32_t>()),
+                                 result["saturation"].as<double>());
+    profiler.Start();
+
+    try {
+        client->Connect();
+    } catch (const std::exception& e) {
+        SPDLOG_LOGGER_CRITICAL(
+          logger, "Failed to connect to relay '{0}' with exception: {1}", client_config.connect_uri, e.what());
+        return EXIT_FAILURE;
+    } catch (...) {
+        SPDLOG_LOGGER_CRITICAL(logger, "Unexpected error connecting to relay");
+        return EXIT_FAILURE;
+    }
+
+    while (!terminate && !client->GetTerminateStatus() && !client->HandlersComplete()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    client->Terminate();
+    client->Disconnect();
+
+    profiler.Report(endpoint_test_id, client->GetLoad());
+    profiler.Stop();
+
+    qperf::ReportAsyncLogger(endpoint_test_id);
+
+    return EXIT_SUCCESS;
+}
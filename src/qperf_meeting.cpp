@@ -1,18 +1,26 @@
 // SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include "async_log_sink.hpp"
+#include "join_scheduler.hpp"
 #include "publisher_track_handler.hpp"
+#include "reconnector.hpp"
+#include "relay_placement.hpp"
+#include "self_profiler.hpp"
+#include "subscriber_aggregator.hpp"
 #include "subscriber_track_handler.hpp"
+#include "sync_skew.hpp"
 
 #include <cxxopts.hpp>
 #include <quicr/client.h>
 #include <quicr/defer.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <thread>
@@ -27,25 +35,50 @@ class PerfClient : public quicr::Client
                const std::string& configfile,
                std::uint32_t meeting_id,
                std::uint32_t instances,
-               std::uint32_t instance_identifier)
+               std::uint32_t instance_identifier,
+               std::shared_ptr<SubscriberAggregator> aggregator,
+               const std::string& trace_prefix,
+               std::uint8_t relay_index,
+               const ReconnectConfig& reconnect_config)
       : quicr::Client(cfg)
       , configfile_(configfile)
       , meeting_id_(meeting_id)
       , instance_id_(instance_identifier)
       , instances_(instances)
+      , aggregator_(std::move(aggregator))
+      , trace_prefix_(trace_prefix)
+      , relay_index_(relay_index)
+      , reconnector_(reconnect_config)
     {
     }
 
     void StatusChanged(Status status)
     {
         switch (status) {
-            case Status::kReady:
+            case Status::kReady: {
                 SPDLOG_INFO("Client status - kReady");
+                const auto outage_start_us = reconnector_.Ready();
+                std::lock_guard<std::mutex> _(mutex_);
+                if (!pub_track_handlers_.empty()) {
+                    // Reconnected, restore the tracks of the running meeting
+                    for (auto handler : pub_track_handlers_) {
+                        PublishTrack(handler);
+                    }
+                    for (auto handler : sub_track_handlers_) {
+                        if (handler->Joined()) {
+                            handler->Resubscribing(outage_start_us);
+                            SubscribeTrack(handler);
+                        }
+                    }
+                    break;
+                }
+
                 inif_.load(configfile_);
 
                 for (const auto& [section_name, _] : inif_) {
                     auto pub_handler = pub_track_handlers_.emplace_back(
-                      PerfPublishTrackHandler::Create(section_name, inif_, instance_id_ + (meeting_id_ * 1000)));
+                      PerfPublishTrackHandler::Create(
+                        section_name, inif_, instance_id_ + (meeting_id_ * 1000), relay_index_));
                     PublishTrack(pub_handler);
                 }
 
@@ -54,14 +87,18 @@ class PerfClient : public quicr::Client
                         continue;
                     }
 
+                    // The first track of the config is the reference of the participant's sync skew
+                    auto sync_skew = sync_skews_.emplace_back(std::make_shared<SyncSkewTracker>(i));
                     for (const auto& [section_name, _] : inif_) {
                         auto sub_handler = sub_track_handlers_.emplace_back(
-                          PerfSubscribeTrackHandler::Create(section_name, inif_, i + (meeting_id_ * 1000)));
-                        SubscribeTrack(sub_handler);
+                          PerfSubscribeTrackHandler::Create(
+                            section_name, inif_, i + (meeting_id_ * 1000), trace_prefix_, relay_index_));
+                        sub_handler->SetSyncSkew(sync_skew);
+                        aggregator_->Register(sub_handler);
+                        Join(sub_handler);
                     }
                 }
-
-                break;
+            } break;
             case Status::kNotReady:
                 SPDLOG_INFO("Client status - kNotReady");
                 break;
@@ -70,6 +107,7 @@ class PerfClient : public quicr::Client
                 break;
             case Status::kNotConnected:
                 SPDLOG_INFO("Client status - kNotConnected");
+                reconnector_.Lost();
                 break;
             case Status::kPendingServerSetup:
                 SPDLOG_INFO("Client status - kPendingSeverSetup");
@@ -77,6 +115,9 @@ class PerfClient : public quicr::Client
 
             case Status::kFailedToConnect:
                 SPDLOG_ERROR("Client status - kFailedToConnect");
+                if (reconnector_.Lost()) {
+                    break;
+                }
                 terminate_ = true;
                 break;
             case Status::kInternalError:
@@ -118,8 +159,42 @@ class PerfClient : public quicr::Client
         return true;
     }
 
+    ClientLoad GetLoad()
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+        ClientLoad load;
+        memset(&load, '\0', sizeof(load));
+
+        for (auto handler : pub_track_handlers_) {
+            const auto& wakeup = handler->GetWakeupStats();
+            load.objects += handler->PublishedObjects();
+            load.wakeup.samples += wakeup.samples;
+            load.wakeup.total_lateness_us += wakeup.total_lateness_us;
+            load.wakeup.max_lateness_us = std::max(load.wakeup.max_lateness_us, wakeup.max_lateness_us);
+            load.wakeup.late_wakeups += wakeup.late_wakeups;
+        }
+
+        for (auto handler : sub_track_handlers_) {
+            load.objects += handler->TotalObjects();
+        }
+
+        return load;
+    }
+
+    void ReportSyncSkew(const std::string& endpoint_id)
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+        for (const auto& sync_skew : sync_skews_) {
+            sync_skew->Report(endpoint_id);
+        }
+    }
+
+    void PollReconnect() { reconnector_.Poll(*this); }
+    void ReportReconnects(const std::string& endpoint_id) { reconnector_.Report(endpoint_id); }
+
     void Terminate()
     {
+        join_scheduler_.Stop();
         std::lock_guard<std::mutex> _(mutex_);
 
         for (auto handler : sub_track_handlers_) {
@@ -136,17 +211,38 @@ class PerfClient : public quicr::Client
     }
 
   private:
+    void Join(const std::shared_ptr<PerfSubscribeTrackHandler>& handler)
+    {
+        if (handler->JoinDelay().count() == 0) {
+            handler->Joining();
+            SubscribeTrack(handler);
+            return;
+        }
+
+        SPDLOG_INFO("Joining {} in {} ms", handler->TestName(), handler->JoinDelay().count());
+        join_scheduler_.Schedule(handler->JoinDelay(), [this, handler] {
+            handler->Joining();
+            SubscribeTrack(handler);
+        });
+    }
+
     bool terminate_;
     std::string configfile_;
     ini::IniFile inif_;
     std::uint32_t meeting_id_;
     std::uint32_t instance_id_;
     std::uint32_t instances_;
+    std::shared_ptr<SubscriberAggregator> aggregator_;
+    std::string trace_prefix_;
+    std::uint8_t relay_index_;
 
     std::vector<std::shared_ptr<PerfSubscribeTrackHandler>> sub_track_handlers_;
     std::vector<std::shared_ptr<PerfPublishTrackHandler>> pub_track_handlers_;
+    std::vector<std::shared_ptr<SyncSkewTracker>> sync_skews_;
 
     std::mutex mutex_;
+    JoinScheduler join_scheduler_;
+    Reconnector reconnector_;
 };
 
 std::atomic_bool terminate = false;
@@ -164,11 +260,20 @@ main(int argc, char** argv)
     cxxopts::Options options("QPerf");
     options.add_options()
         ("endpoint_id",     "Name of the client",               cxxopts::value<std::string>()->default_value("perf@cisco.com"))
-        ("connect_uri",     "Relay to connect to",              cxxopts::value<std::string>()->default_value("moq://localhost:1234"))
+        ("connect_uri",     "Relays to connect to, comma sep.", cxxopts::value<std::string>()->default_value("moq://localhost:1234"))
+        ("placement",       "round_robin, pinned or random",    cxxopts::value<std::string>()->default_value("round_robin"))
+        ("relay_index",     "Relay of the pinned placement",    cxxopts::value<std::uint32_t>()->default_value("0"))
         ("meeting_id",      "Meeting identifier",               cxxopts::value<std::uint32_t>()->default_value("1"))
         ("n,instances",     "Number of instances being run",    cxxopts::value<std::uint32_t>())
         ("i,instance_id",   "Instance identifier number",       cxxopts::value<std::uint32_t>())
         ("c,config",        "Scenario config file",             cxxopts::value<std::string>())
+        ("profile_ms",      "Self profile interval (ms)",       cxxopts::value<std::uint32_t>()->default_value("1000"))
+        ("saturation",      "CPU % marking client saturated",   cxxopts::value<double>()->default_value("90"))
+        ("agg_threads",     "Subscriber statistics threads",    cxxopts::value<std::uint32_t>()->default_value("1"))
+        ("trace_dir",       "Received object trace directory",  cxxopts::value<std::string>()->default_value(""))
+        ("reconnect",       "Reconnect when the relay is lost", cxxopts::value<bool>()->default_value("false"))
+        ("reconnect_ms",    "Initial reconnect backoff (ms)",   cxxopts::value<std::uint32_t>()->default_value("250"))
+        ("reconnect_max",   "Maximum reconnect backoff (ms)",   cxxopts::value<std::uint32_t>()->default_value("5000"))
         ("h,help",          "Print usage");
     // clang-format on
 
@@ -197,7 +302,6 @@ main(int argc, char** argv)
       result["endpoint_id"].as<std::string>() + ":" + std::to_string(result["instance_id"].as<std::uint32_t>());
 
     quicr::ClientConfig client_config;
-    client_config.connect_uri = result["connect_uri"].as<std::string>();
     client_config.endpoint_id = endpoint_instance_id;
     client_config.metrics_sample_ms = 5000;
     client_config.transport_config = config;
@@ -205,17 +309,46 @@ main(int argc, char** argv)
 
     auto log_id = endpoint_instance_id;
 
-    const auto logger = spdlog::stderr_color_mt(log_id);
+    const auto logger = CreateAsyncLogger(log_id);
 
     const auto meeting_id = result["meeting_id"].as<std::uint32_t>();
     const auto instance_id = result["instance_id"].as<std::uint32_t>();
     const auto instances = result["instances"].as<std::uint32_t>();
 
-    auto client = std::make_shared<PerfClient>(
-      client_config, result["config"].as<std::string>(), meeting_id, instances, instance_id);
+    // Participants of a meeting are spread over the relays by instance id
+    const auto relay = SelectRelay(result["connect_uri"].as<std::string>(),
+                                   result["placement"].as<std::string>(),
+                                   instance_id,
+                                   result["relay_index"].as<std::uint32_t>());
+    client_config.connect_uri = relay.uri;
+
+    auto aggregator = std::make_shared<SubscriberAggregator>(result["agg_threads"].as<std::uint32_t>());
+
+    const auto trace_dir = result["trace_dir"].as<std::string>();
+    const auto trace_prefix =
+      trace_dir.empty() ? "" : fmt::format("{}/m_{}_{}", trace_dir, meeting_id, instance_id);
+
+    ReconnectConfig reconnect_config;
+    reconnect_config.enabled = result["reconnect"].as<bool>();
+    reconnect_config.initial_backoff = std::chrono::milliseconds(result["reconnect_ms"].as<std::uint32_t>());
+    reconnect_config.max_backoff = std::chrono::milliseconds(result["reconnect_max"].as<std::uint32_t>());
+
+    auto client = std::make_shared<PerfClient>(client_config,
+                                               result["config"].as<std::string>(),
+                                               meeting_id,
+                                               instances,
+                                               instance_id,
+                                               aggregator,
+                                               trace_prefix,
+                                               relay.index,
+                                               reconnect_config);
 
     std::signal(SIGINT, HandleTerminateSignal);
 
+    SelfProfiler profiler(std::chrono::milliseconds(result["profile_ms"].as<std::uint32_t>()),
+                          result["saturation"].as<double>());
+    profiler.Start();
+
     try {
         client->Connect();
     } catch (const std::exception& e) {
@@ -228,11 +361,20 @@ main(int argc, char** argv)
     }
 
     while (!terminate && !client->HandlersComplete()) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        client->PollReconnect();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
     client->Terminate();
     client->Disconnect();
+    aggregator->Stop();
+
+    client->ReportSyncSkew(endpoint_instance_id);
+    client->ReportReconnects(endpoint_instance_id);
+    profiler.Report(endpoint_instance_id, client->GetLoad());
+    profiler.Stop();
+
+    ReportAsyncLogger(endpoint_instance_id);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,493 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "async_log_sink.hpp"
+#include "impairment.hpp"
+#include "inicpp.h"
+
+#include <cxxopts.hpp>
+#include <spdlog/spdlog.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+using namespace qperf;
+
+namespace {
+    constexpr std::size_t kMaxPacketSize = 2048;
+    constexpr std::size_t kMaxReadsPerSocket = 64;
+
+    enum class Direction : uint8_t
+    {
+        kUpstream,  // client -> relay
+        kDownstream // relay -> client
+    };
+
+    bool ResolveAddress(const std::string& host,
+                        const std::string& port,
+                        bool passive,
+                        sockaddr_storage& addr,
+                        socklen_t& addr_len)
+    {
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+            return false;
+        }
+
+        memcpy(&addr, result->ai_addr, result->ai_addrlen);
+        addr_len = result->ai_addrlen;
+        freeaddrinfo(result);
+        return true;
+    }
+
+    /**
+     * @brief Split a relay URI such as moq://relay:1234 into host and port
+     */
+    bool ParseRelayUri(const std::string& uri, std::string& host, std::string& port)
+    {
+        auto start = uri.find("://");
+        start = start == std::string::npos ? 0 : start + 3;
+
+        auto colon = uri.rfind(':');
+        if (colon == std::string::npos || colon < start) {
+            return false;
+        }
+
+        host = uri.substr(start, colon - start);
+        port = uri.substr(colon + 1);
+        if (!host.empty() && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+        return !host.empty() && !port.empty();
+    }
+
+    int OpenSocket(int family)
+    {
+        int fd = socket(family, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            return fd;
+        }
+
+        int buffer_size = 8 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        return fd;
+    }
+}
+
+/**
+ * @brief UDP proxy that applies an impairment schedule between qperf clients and a relay
+ * @details Every client source address gets its own upstream socket to the relay, so the relay
+ *          sees one 5-tuple per client. Packet payloads live in a preallocated pool and the delay
+ *          line is a min heap of pool indices, so steady state forwarding does not allocate.
+ */
+class ImpairmentProxy
+{
+    using Clock = ImpairmentEngine::Clock;
+
+    struct Flow
+    {
+        sockaddr_storage client_addr;
+        socklen_t client_addr_len;
+        int upstream_fd;
+    };
+
+    struct PendingPacket
+    {
+        Clock::time_point release_time;
+        Clock::time_point receive_time;
+        std::uint64_t sequence;
+        std::uint32_t slot;
+        std::uint32_t flow;
+        std::uint16_t size;
+        Direction direction;
+
+        bool operator>(const PendingPacket& other) const
+        {
+            return release_time == other.release_time ? sequence > other.sequence
+                                                      : release_time > other.release_time;
+        }
+    };
+
+  public:
+    ImpairmentProxy(const std::vector<ImpairmentConfig>& schedule, std::uint64_t seed, std::size_t max_queued)
+      : upstream_engine_(schedule, seed)
+      , downstream_engine_(schedule, seed + 1)
+      , pool_(max_queued * kMaxPacketSize)
+    {
+        free_slots_.reserve(max_queued);
+        for (std::size_t i = max_queued; i > 0; --i) {
+            free_slots_.push_back(static_cast<std::uint32_t>(i - 1));
+        }
+
+        std::vector<PendingPacket> storage;
+        storage.reserve(max_queued);
+        pending_ = decltype(pending_)(std::greater<PendingPacket>(), std::move(storage));
+    }
+
+    ~ImpairmentProxy()
+    {
+        for (const auto& flow : flows_) {
+            close(flow.upstream_fd);
+        }
+        if (listen_fd_ >= 0) {
+            close(listen_fd_);
+        }
+    }
+
+    bool Open(const sockaddr_storage& listen_addr,
+              socklen_t listen_addr_len,
+              const sockaddr_storage& relay_addr,
+              socklen_t relay_addr_len)
+    {
+        relay_addr_ = relay_addr;
+        relay_addr_len_ = relay_addr_len;
+
+        listen_fd_ = OpenSocket(listen_addr.ss_family);
+        if (listen_fd_ < 0 || bind(listen_fd_, reinterpret_cast<const sockaddr*>(&listen_addr), listen_addr_len) < 0) {
+            SPDLOG_ERROR("Failed to bind listen socket: {}", strerror(errno));
+            return false;
+        }
+
+        poll_fds_.push_back({ listen_fd_, POLLIN, 0 });
+        return true;
+    }
+
+    void Run(const std::atomic_bool& terminate, std::uint32_t report_interval_s)
+    {
+        SPDLOG_INFO("NETEM phase {}", ImpairmentToString(upstream_engine_.ActivePhase()));
+
+        auto next_report = Clock::now() + std::chrono::seconds(report_interval_s);
+
+        while (!terminate) {
+            auto now = Clock::now();
+
+            if (upstream_engine_.UpdatePhase(now)) {
+                SPDLOG_INFO("NETEM phase {}", ImpairmentToString(upstream_engine_.ActivePhase()));
+            }
+            downstream_engine_.UpdatePhase(now);
+
+            ReleaseDue(now);
+
+            int timeout_ms = 100;
+            if (!pending_.empty()) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(pending_.top().release_time - now);
+                timeout_ms = static_cast<int>(std::clamp<std::int64_t>(wait.count(), 0, timeout_ms));
+            }
+
+            if (poll(poll_fds_.data(), poll_fds_.size(), timeout_ms) > 0) {
+                // Index based, accepting a new client appends to poll_fds_
+                const auto num_fds = poll_fds_.size();
+                for (std::size_t i = 0; i < num_fds; ++i) {
+                    if (!(poll_fds_[i].revents & POLLIN)) {
+                        continue;
+                    }
+
+                    if (i == 0) {
+                        ReadClients();
+                    } else {
+                        ReadRelay(static_cast<std::uint32_t>(i - 1));
+                    }
+                }
+            }
+
+            if (report_interval_s > 0 && Clock::now() >= next_report) {
+                Report("NETEM");
+                next_report += std::chrono::seconds(report_interval_s);
+            }
+        }
+
+        Report("NETEM COMPLETE");
+    }
+
+  private:
+    void ReadClients()
+    {
+        for (std::size_t n = 0; n < kMaxReadsPerSocket; ++n) {
+            sockaddr_storage from;
+            socklen_t from_len = sizeof(from);
+            auto* buffer = ReadBuffer();
+
+            auto bytes = recvfrom(listen_fd_, buffer, kMaxPacketSize, 0, reinterpret_cast<sockaddr*>(&from), &from_len);
+            if (bytes <= 0) {
+                return;
+            }
+
+            if (free_slots_.empty()) {
+                upstream_engine_.DroppedQueue(static_cast<std::size_t>(bytes));
+                continue;
+            }
+
+            auto flow = FindOrAddFlow(from, from_len);
+            if (flow < 0) {
+                continue;
+            }
+
+            Enqueue(Direction::kUpstream, static_cast<std::uint32_t>(flow), static_cast<std::size_t>(bytes));
+        }
+    }
+
+    void ReadRelay(std::uint32_t flow)
+    {
+        for (std::size_t n = 0; n < kMaxReadsPerSocket; ++n) {
+            auto* buffer = ReadBuffer();
+
+            auto bytes = recv(flows_[flow].upstream_fd, buffer, kMaxPacketSize, 0);
+            if (bytes <= 0) {
+                return;
+            }
+
+            if (free_slots_.empty()) {
+                downstream_engine_.DroppedQueue(static_cast<std::size_t>(bytes));
+                continue;
+            }
+
+            Enqueue(Direction::kDownstream, flow, static_cast<std::size_t>(bytes));
+        }
+    }
+
+    /**
+     * @brief Buffer to read the next packet into
+     * @details The next free pool slot, or a scratch buffer when every slot is queued. The packet is
+     *          still read and then dropped, so a full pool does not leave the socket readable and spin poll.
+     */
+    std::uint8_t* ReadBuffer()
+    {
+        if (free_slots_.empty()) {
+            return scratch_.data();
+        }
+        return &pool_[free_slots_.back() * kMaxPacketSize];
+    }
+
+    void Enqueue(Direction direction, std::uint32_t flow, std::size_t size)
+    {
+        auto now = Clock::now();
+        auto& engine = direction == Direction::kUpstream ? upstream_engine_ : downstream_engine_;
+
+        auto release_time = engine.Apply(now, size);
+        if (!release_time.has_value()) {
+            return;
+        }
+
+        auto slot = free_slots_.back();
+        free_slots_.pop_back();
+        pending_.push({ *release_time,
+                        now,
+                        sequence_++,
+                        slot,
+                        flow,
+                        static_cast<std::uint16_t>(size),
+                        direction });
+    }
+
+    void ReleaseDue(Clock::time_point now)
+    {
+        while (!pending_.empty() && pending_.top().release_time <= now) {
+            const auto packet = pending_.top();
+            pending_.pop();
+
+            const auto& flow = flows_[packet.flow];
+            const auto* buffer = &pool_[packet.slot * kMaxPacketSize];
+
+            if (packet.direction == Direction::kUpstream) {
+                send(flow.upstream_fd, buffer, packet.size, 0);
+                upstream_engine_.Forwarded(
+                  std::chrono::duration_cast<std::chrono::microseconds>(now - packet.receive_time));
+            } else {
+                sendto(listen_fd_,
+                       buffer,
+                       packet.size,
+                       0,
+                       reinterpret_cast<const sockaddr*>(&flow.client_addr),
+                       flow.client_addr_len);
+                downstream_engine_.Forwarded(
+                  std::chrono::duration_cast<std::chrono::microseconds>(now - packet.receive_time));
+            }
+
+            free_slots_.push_back(packet.slot);
+        }
+    }
+
+    int FindOrAddFlow(const sockaddr_storage& from, socklen_t from_len)
+    {
+        std::string key(reinterpret_cast<const char*>(&from), from_len);
+        auto it = flow_index_.find(key);
+        if (it != flow_index_.end()) {
+            return static_cast<int>(it->second);
+        }
+
+        int fd = OpenSocket(relay_addr_.ss_family);
+        if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&relay_addr_), relay_addr_len_) < 0) {
+            SPDLOG_ERROR("Failed to open upstream socket for new client: {}", strerror(errno));
+            if (fd >= 0) {
+                close(fd);
+            }
+            return -1;
+        }
+
+        flows_.push_back({ from, from_len, fd });
+        poll_fds_.push_back({ fd, POLLIN, 0 });
+        flow_index_.emplace(std::move(key), flows_.size() - 1);
+
+        SPDLOG_INFO("NETEM new client flow {}", flows_.size() - 1);
+        return static_cast<int>(flows_.size() - 1);
+    }
+
+    void Report(const std::string& prefix)
+    {
+        // prefix, direction, phase, packets, bytes, dropped_loss, dropped_queue, reordered, forwarded,
+        //      avg_delay_us, max_delay_us, clients
+        for (auto direction : { Direction::kUpstream, Direction::kDownstream }) {
+            const auto& engine = direction == Direction::kUpstream ? upstream_engine_ : downstream_engine_;
+            const auto& stats = engine.Stats();
+            SPDLOG_INFO("{}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+                        prefix,
+                        direction == Direction::kUpstream ? "upstream" : "downstream",
+                        engine.ActivePhase().name,
+                        stats.packets,
+                        stats.bytes,
+                        stats.dropped_loss,
+                        stats.dropped_queue,
+                        stats.reordered,
+                        stats.forwarded,
+                        stats.forwarded ? stats.total_delay_us / stats.forwarded : 0,
+                        stats.max_delay_us,
+                        flows_.size());
+        }
+    }
+
+    ImpairmentEngine upstream_engine_;
+    ImpairmentEngine downstream_engine_;
+
+    int listen_fd_{ -1 };
+    sockaddr_storage relay_addr_;
+    socklen_t relay_addr_len_{ 0 };
+
+    std::vector<Flow> flows_;
+    std::map<std::string, std::size_t> flow_index_;
+    std::vector<pollfd> poll_fds_;
+
+    std::vector<std::uint8_t> pool_;
+    std::vector<std::uint32_t> free_slots_;
+    std::array<std::uint8_t, kMaxPacketSize> scratch_;
+    std::priority_queue<PendingPacket, std::vector<PendingPacket>, std::greater<PendingPacket>> pending_;
+    std::uint64_t sequence_{ 0 };
+};
+
+std::atomic_bool terminate = false;
+
+void
+HandleTerminateSignal(int)
+{
+    terminate = true;
+}
+
+int
+main(int argc, char** argv)
+{
+    // clang-format off
+    cxxopts::Options options("QPerf Netem");
+    options.add_options()
+        ("listen_addr",     "Local address to accept clients on",           cxxopts::value<std::string>()->default_value("0.0.0.0"))
+        ("listen_port",     "Local port clients connect to",                cxxopts::value<std::string>()->default_value("1235"))
+        ("connect_uri",     "Relay to forward to",                          cxxopts::value<std::string>()->default_value("moq://localhost:1234"))
+        ("c,config",        "Impairment schedule config file",              cxxopts::value<std::string>())
+        ("seed",            "Random seed for loss, delay and reordering",   cxxopts::value<std::uint64_t>()->default_value("1"))
+        ("max_queued",      "Maximum packets held in the delay line",       cxxopts::value<std::size_t>()->default_value("16384"))
+        ("report_interval", "Seconds between stats reports, 0 disables",    cxxopts::value<std::uint32_t>()->default_value("5"))
+        ("h,help",          "Print usage");
+    // clang-format on
+
+    cxxopts::ParseResult result;
+
+    try {
+        result = options.parse(argc, argv);
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << "Caught exception while parsing arguments: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (result.count("help") || !result.count("config")) {
+        std::cerr << options.help() << std::endl;
+        return result.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const auto logger = CreateAsyncLogger("NETEM");
+
+    ini::IniFile inif;
+    inif.load(result["config"].as<std::string>());
+
+    std::vector<ImpairmentConfig> schedule;
+    if (!PopulateImpairmentSchedule(inif, schedule)) {
+        return EXIT_FAILURE;
+    }
+
+    std::string relay_host;
+    std::string relay_port;
+    if (!ParseRelayUri(result["connect_uri"].as<std::string>(), relay_host, relay_port)) {
+        SPDLOG_ERROR("Invalid relay uri '{}'", result["connect_uri"].as<std::string>());
+        return EXIT_FAILURE;
+    }
+
+    sockaddr_storage relay_addr;
+    socklen_t relay_addr_len = 0;
+    if (!ResolveAddress(relay_host, relay_port, false, relay_addr, relay_addr_len)) {
+        SPDLOG_ERROR("Failed to resolve relay {}:{}", relay_host, relay_port);
+        return EXIT_FAILURE;
+    }
+
+    sockaddr_storage listen_addr;
+    socklen_t listen_addr_len = 0;
+    if (!ResolveAddress(result["listen_addr"].as<std::string>(),
+                        result["listen_port"].as<std::string>(),
+                        true,
+                        listen_addr,
+                        listen_addr_len)) {
+        SPDLOG_ERROR("Failed to resolve listen address");
+        return EXIT_FAILURE;
+    }
+
+    SPDLOG_INFO("--------------------------------------------");
+    SPDLOG_INFO("Starting...netem");
+    SPDLOG_INFO("\tlisten {}:{}", result["listen_addr"].as<std::string>(), result["listen_port"].as<std::string>());
+    SPDLOG_INFO("\trelay {}:{}", relay_host, relay_port);
+    for (const auto& phase : schedule) {
+        SPDLOG_INFO("\t{}", ImpairmentToString(phase));
+    }
+    SPDLOG_INFO("--------------------------------------------");
+
+    ImpairmentProxy proxy(schedule, result["seed"].as<std::uint64_t>(), result["max_queued"].as<std::size_t>());
+    if (!proxy.Open(listen_addr, listen_addr_len, relay_addr, relay_addr_len)) {
+        return EXIT_FAILURE;
+    }
+
+    std::signal(SIGINT, HandleTerminateSignal);
+    std::signal(SIGTERM, HandleTerminateSignal);
+
+    proxy.Run(terminate, result["report_interval"].as<std::uint32_t>());
+
+    ReportAsyncLogger("netem");
+
+    return EXIT_SUCCESS;
+}
@@ -1,18 +1,23 @@
 // SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include "async_log_sink.hpp"
 #include "publisher_track_handler.hpp"
 #include "qperf.hpp"
+#include "reconnector.hpp"
+#include "relay_placement.hpp"
+#include "self_profiler.hpp"
 
 #include <cxxopts.hpp>
 #include <quicr/client.h>
 #include <quicr/defer.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <thread>
@@ -21,9 +26,14 @@
 class PerfPubClient : public quicr::Client
 {
   public:
-    PerfPubClient(const quicr::ClientConfig& cfg, const std::string& configfile)
+    PerfPubClient(const quicr::ClientConfig& cfg,
+                  const std::string& configfile,
+                  std::uint8_t relay_index,
+                  const qperf::ReconnectConfig& reconnect_config)
       : quicr::Client(cfg)
       , configfile_(configfile)
+      , relay_index_(relay_index)
+      , reconnector_(reconnect_config)
     {
     }
 
@@ -33,11 +43,20 @@ class PerfPubClient : public quicr::Client
         switch (status) {
             case Status::kReady:
                 SPDLOG_INFO("PerfPubClient - kReady");
+                reconnector_.Ready();
+                if (!track_handlers_.empty()) {
+                    // Reconnected, the writers kept running and resume once the tracks are published again
+                    for (auto handler : track_handlers_) {
+                        PublishTrack(handler);
+                    }
+                    break;
+                }
+
                 inif_.load(configfile_);
                 for (const auto& section_pair : inif_) {
                     const std::string& section_name = section_pair.first;
-                    auto pub_handler =
-                      track_handlers_.emplace_back(qperf::PerfPublishTrackHandler::Create(section_name, inif_, 0));
+                    auto pub_handler = track_handlers_.emplace_back(
+                      qperf::PerfPublishTrackHandler::Create(section_name, inif_, 0, relay_index_));
                     PublishTrack(pub_handler);
                 }
                 break;
@@ -65,10 +84,18 @@ class PerfPubClient : public quicr::Client
                 terminate_ = true;
                 break;
             case Status::kNotConnected:
+                if (reconnector_.Lost()) {
+                    SPDLOG_INFO("PerfPubClient - kNotConnected - reconnect");
+                    break;
+                }
                 SPDLOG_INFO("PerfPubClient - kNotConnected - terminate");
                 terminate_ = true;
                 break;
             case Status::kFailedToConnect:
+                if (reconnector_.Lost()) {
+                    SPDLOG_INFO("PerfPubClient - kFailedToConnect - reconnect");
+                    break;
+                }
                 SPDLOG_INFO("PerfPubClient - kFailedToConnect - terminate");
                 terminate_ = true;
                 break;
@@ -101,6 +128,25 @@ class PerfPubClient : public quicr::Client
         return ret;
     }
 
+    qperf::ClientLoad GetLoad()
+    {
+        std::lock_guard<std::mutex> _(track_handlers_mutex_);
+        qperf::ClientLoad load;
+        memset(&load, '\0', sizeof(load));
+        for (auto handler : track_handlers_) {
+            const auto& wakeup = handler->GetWakeupStats();
+            load.objects += handler->PublishedObjects();
+            load.wakeup.samples += wakeup.samples;
+            load.wakeup.total_lateness_us += wakeup.total_lateness_us;
+            load.wakeup.max_lateness_us = std::max(load.wakeup.max_lateness_us, wakeup.max_lateness_us);
+            load.wakeup.late_wakeups += wakeup.late_wakeups;
+        }
+        return load;
+    }
+
+    void PollReconnect() { reconnector_.Poll(*this); }
+    void ReportReconnects(const std::string& endpoint_id) { reconnector_.Report(endpoint_id); }
+
     void Terminate()
     {
         std::lock_guard<std::mutex> _(track_handlers_mutex_);
@@ -118,8 +164,10 @@ class PerfPubClient : public quicr::Client
     bool terminate_;
     std::string configfile_;
     ini::IniFile inif_;
+    std::uint8_t relay_index_;
     std::vector<std::shared_ptr<qperf::PerfPublishTrackHandler>> track_handlers_;
     std::mutex track_handlers_mutex_;
+    qperf::Reconnector reconnector_;
 };
 
 bool terminate = false;
@@ -137,8 +185,15 @@ main(int argc, char** argv)
     cxxopts::Options options("QPerf");
     options.add_options()
         ("endpoint_id",     "Name of the client",                                    cxxopts::value<std::string>()->default_value("perf@cisco.com"))
-        ("connect_uri",     "Relay to connect to",                                   cxxopts::value<std::string>()->default_value("moq://localhost:1234"))
+        ("connect_uri",     "Relays to connect to, comma separated",                 cxxopts::value<std::string>()->default_value("moq://localhost:1234"))
+        ("placement",       "Relay placement (round_robin|pinned|random)",           cxxopts::value<std::string>()->default_value("round_robin"))
+        ("relay_index",     "Relay of the pinned placement",                         cxxopts::value<std::uint32_t>()->default_value("0"))
         ("c,config",        "Scenario config file",                                  cxxopts::value<std::string>()->default_value("./config.ini"))
+        ("profile_ms",      "Self profile interval (ms)",                            cxxopts::value<std::uint32_t>()->default_value("1000"))
+        ("saturation",      "CPU % marking client saturated",                        cxxopts::value<double>()->default_value("90"))
+        ("reconnect",       "Reconnect and restore tracks when the relay is lost",   cxxopts::value<bool>()->default_value("false"))
+        ("reconnect_ms",    "Initial reconnect backoff (ms)",                        cxxopts::value<std::uint32_t>()->default_value("250"))
+        ("reconnect_max",   "Maximum reconnect backoff (ms)",                        cxxopts::value<std::uint32_t>()->default_value("5000"))
         ("h,help",          "Print usage");
     // clang-format on
 
@@ -167,10 +222,16 @@ main(int argc, char** argv)
     client_config.endpoint_id = result["endpoint_id"].as<std::string>();
     client_config.metrics_sample_ms = 5000;
     client_config.transport_config = config;
-    client_config.connect_uri = result["connect_uri"].as<std::string>();
     client_config.tick_service_sleep_delay_us = 50000;
 
-    const auto logger = spdlog::stderr_color_mt("PERF");
+    const auto logger = qperf::CreateAsyncLogger("PERF");
+
+    // A single publisher has no client index, round robin places it on the pinned relay
+    const auto relay = qperf::SelectRelay(result["connect_uri"].as<std::string>(),
+                                          result["placement"].as<std::string>(),
+                                          result["relay_index"].as<std::uint32_t>(),
+                                          result["relay_index"].as<std::uint32_t>());
+    client_config.connect_uri = relay.uri;
 
     auto config_file = result["config"].as<std::string>();
     SPDLOG_INFO("--------------------------------------------");
@@ -183,7 +244,16 @@ main(int argc, char** argv)
 
     std::signal(SIGINT, HandleTerminateSignal);
 
-    auto client = std::make_shared<PerfPubClient>(client_config, config_file);
+    qperf::ReconnectConfig reconnect_config;
+    reconnect_config.enabled = result["reconnect"].as<bool>();
+    reconnect_config.initial_backoff = std::chrono::milliseconds(result["reconnect_ms"].as<std::uint32_t>());
+    reconnect_config.max_backoff = std::chrono::milliseconds(result["reconnect_max"].as<std::uint32_t>());
+
+    auto client = std::make_shared<PerfPubClient>(client_config, config_file, relay.index, reconnect_config);
+
+    qperf::SelfProfiler profiler(std::chrono::milliseconds(result["profile_ms"].as<std::uint32_t>()),
+                                 result["saturation"].as<double>());
+    profiler.Start();
 
     try {
         client->Connect();
@@ -197,10 +267,18 @@ main(int argc, char** argv)
     }
 
     while (!terminate && !client->HandlersComplete()) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        client->PollReconnect();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
     client->Terminate();
     client->Disconnect();
+
+    client->ReportReconnects(client_config.endpoint_id);
+    profiler.Report(client_config.endpoint_id, client->GetLoad());
+    profiler.Stop();
+
+    qperf::ReportAsyncLogger(client_config.endpoint_id);
+
     return EXIT_SUCCESS;
 }
@@ -1,17 +1,23 @@
 // SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
 // SPDX-License-Identifier: BSD-2-Clause
 
+#include "async_log_sink.hpp"
+#include "join_scheduler.hpp"
+#include "reconnector.hpp"
+#include "relay_placement.hpp"
+#include "self_profiler.hpp"
+#include "subscriber_aggregator.hpp"
 #include "subscriber_track_handler.hpp"
 
 #include <cxxopts.hpp>
 #include <quicr/client.h>
 #include <quicr/defer.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
 #include <atomic>
 #include <chrono>
 #include <csignal>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <thread>
@@ -20,27 +26,51 @@
 class PerfSubClient : public quicr::Client
 {
   public:
-    PerfSubClient(const quicr::ClientConfig& cfg, const std::string& configfile, std::uint32_t test_identifier)
+    PerfSubClient(const quicr::ClientConfig& cfg,
+                  const std::string& configfile,
+                  std::uint32_t test_identifier,
+                  std::shared_ptr<qperf::SubscriberAggregator> aggregator,
+                  const std::string& trace_prefix,
+                  std::uint8_t relay_index,
+                  const qperf::ReconnectConfig& reconnect_config)
       : quicr::Client(cfg)
       , configfile_(configfile)
       , test_identifier_(test_identifier)
+      , aggregator_(std::move(aggregator))
+      , trace_prefix_(trace_prefix)
+      , relay_index_(relay_index)
+      , reconnector_(reconnect_config)
     {
     }
 
     void StatusChanged(Status status) override
     {
         switch (status) {
-            case Status::kReady:
+            case Status::kReady: {
                 SPDLOG_INFO("Client status - kReady");
+                const auto outage_start_us = reconnector_.Ready();
+                std::lock_guard<std::mutex> _(track_handlers_mutex_);
+                if (!track_handlers_.empty()) {
+                    // Reconnected, restore the subscribes of the running test
+                    for (auto handler : track_handlers_) {
+                        if (handler->Joined()) {
+                            handler->Resubscribing(outage_start_us);
+                            SubscribeTrack(handler);
+                        }
+                    }
+                    break;
+                }
+
                 inif_.load(configfile_);
                 for (const auto& section_pair : inif_) {
                     const std::string& section_name = section_pair.first;
                     SPDLOG_INFO("Starting test - {}", section_name);
-                    auto sub_handler =
-                      track_handlers_.emplace_back(qperf::PerfSubscribeTrackHandler::Create(section_name, inif_, 0));
-                    SubscribeTrack(sub_handler);
+                    auto sub_handler = track_handlers_.emplace_back(
+                      qperf::PerfSubscribeTrackHandler::Create(section_name, inif_, 0, trace_prefix_, relay_index_));
+                    aggregator_->Register(sub_handler);
+                    Join(sub_handler);
                 }
-                break;
+            } break;
             case Status::kNotReady:
                 SPDLOG_INFO("Client status - kNotReady");
                 break;
@@ -49,6 +79,7 @@ class PerfSubClient : public quicr::Client
                 break;
             case Status::kNotConnected:
                 SPDLOG_INFO("Client status - kNotConnected");
+                reconnector_.Lost();
                 break;
             case Status::kPendingServerSetup:
                 SPDLOG_INFO("Client status - kPendingSeverSetup");
@@ -56,6 +87,9 @@ class PerfSubClient : public quicr::Client
 
             case Status::kFailedToConnect:
                 SPDLOG_ERROR("Client status - kFailedToConnect");
+                if (reconnector_.Lost()) {
+                    break;
+                }
                 terminate_ = true;
                 break;
             case Status::kInternalError:
@@ -93,8 +127,23 @@ class PerfSubClient : public quicr::Client
         return ret;
     }
 
+    qperf::ClientLoad GetLoad()
+    {
+        std::lock_guard<std::mutex> _(track_handlers_mutex_);
+        qperf::ClientLoad load;
+        memset(&load, '\0', sizeof(load));
+        for (auto handler : track_handlers_) {
+            load.objects += handler->TotalObjects();
+        }
+        return load;
+    }
+
+    void PollReconnect() { reconnector_.Poll(*this); }
+    void ReportReconnects(const std::string& endpoint_id) { reconnector_.Report(endpoint_id); }
+
     void Terminate()
     {
+        join_scheduler_.Stop();
         std::lock_guard<std::mutex> _(track_handlers_mutex_);
         for (auto handler : track_handlers_) {
             // Unpublish the track
@@ -106,14 +155,34 @@ class PerfSubClient : public quicr::Client
     }
 
   private:
+    void Join(const std::shared_ptr<qperf::PerfSubscribeTrackHandler>& handler)
+    {
+        if (handler->JoinDelay().count() == 0) {
+            handler->Joining();
+            SubscribeTrack(handler);
+            return;
+        }
+
+        SPDLOG_INFO("Joining {} in {} ms", handler->TestName(), handler->JoinDelay().count());
+        join_scheduler_.Schedule(handler->JoinDelay(), [this, handler] {
+            handler->Joining();
+            SubscribeTrack(handler);
+        });
+    }
+
     bool terminate_;
     std::string configfile_;
     ini::IniFile inif_;
     std::uint32_t test_identifier_;
+    std::shared_ptr<qperf::SubscriberAggregator> aggregator_;
+    std::string trace_prefix_;
+    std::uint8_t relay_index_;
 
     std::vector<std::shared_ptr<qperf::PerfSubscribeTrackHandler>> track_handlers_;
 
     std::mutex track_handlers_mutex_;
+    qperf::JoinScheduler join_scheduler_;
+    qperf::Reconnector reconnector_;
 };
 
 bool terminate = false;
@@ -131,9 +200,18 @@ main(int argc, char** argv)
     cxxopts::Options options("QPerf");
     options.add_options()
         ("endpoint_id",     "Name of the client",                                    cxxopts::value<std::string>()->default_value("perf@cisco.com"))
-        ("connect_uri",     "Relay to connect to",                                   cxxopts::value<std::string>()->default_value("moq://localhost:1234"))
+        ("connect_uri",     "Relays to connect to, comma separated",                 cxxopts::value<std::string>()->default_value("moq://localhost:1234"))
+        ("placement",       "Relay placement (round_robin|pinned|random)",           cxxopts::value<std::string>()->default_value("round_robin"))
+        ("relay_index",     "Relay of the pinned placement",                         cxxopts::value<std::uint32_t>()->default_value("0"))
         ("i,test_id",        "Test idenfiter number",                                cxxopts::value<std::uint32_t>()->default_value("1"))
         ("c,config",        "Scenario config file",                                  cxxopts::value<std::string>())
+        ("profile_ms",      "Self profile interval (ms)",                            cxxopts::value<std::uint32_t>()->default_value("1000"))
+        ("saturation",      "CPU % marking client saturated",                        cxxopts::value<double>()->default_value("90"))
+        ("agg_threads",     "Subscriber statistics threads",                         cxxopts::value<std::uint32_t>()->default_value("1"))
+        ("trace_dir",       "Received object trace directory",                       cxxopts::value<std::string>()->default_value(""))
+        ("reconnect",       "Reconnect and restore tracks when the relay is lost",   cxxopts::value<bool>()->default_value("false"))
+        ("reconnect_ms",    "Initial reconnect backoff (ms)",                        cxxopts::value<std::uint32_t>()->default_value("250"))
+        ("reconnect_max",   "Maximum reconnect backoff (ms)",                        cxxopts::value<std::uint32_t>()->default_value("5000"))
         ("h,help",          "Print usage");
     // clang-format on
 
@@ -162,7 +240,6 @@ main(int argc, char** argv)
       result["endpoint_id"].as<std::string>() + ":" + std::to_string(result["test_id"].as<std::uint32_t>());
 
     quicr::ClientConfig client_config;
-    client_config.connect_uri = result["connect_uri"].as<std::string>();
     client_config.endpoint_id = endpoint_test_id;
     client_config.metrics_sample_ms = 5000;
     client_config.transport_config = config;
@@ -170,14 +247,40 @@ main(int argc, char** argv)
 
     auto log_id = endpoint_test_id;
 
-    const auto logger = spdlog::stderr_color_mt(log_id);
+    const auto logger = qperf::CreateAsyncLogger(log_id);
 
     auto test_identifier = result["test_id"].as<std::uint32_t>();
 
-    auto client = std::make_shared<PerfSubClient>(client_config, result["config"].as<std::string>(), test_identifier);
+    const auto relay = qperf::SelectRelay(result["connect_uri"].as<std::string>(),
+                                          result["placement"].as<std::string>(),
+                                          test_identifier,
+                                          result["relay_index"].as<std::uint32_t>());
+    client_config.connect_uri = relay.uri;
+
+    auto aggregator = std::make_shared<qperf::SubscriberAggregator>(result["agg_threads"].as<std::uint32_t>());
+
+    const auto trace_dir = result["trace_dir"].as<std::string>();
+    const auto trace_prefix = trace_dir.empty() ? "" : trace_dir + "/t_" + std::to_string(test_identifier);
+
+    qperf::ReconnectConfig reconnect_config;
+    reconnect_config.enabled = result["reconnect"].as<bool>();
+    reconnect_config.initial_backoff = std::chrono::milliseconds(result["reconnect_ms"].as<std::uint32_t>());
+    reconnect_config.max_backoff = std::chrono::milliseconds(result["reconnect_max"].as<std::uint32_t>());
+
+    auto client = std::make_shared<PerfSubClient>(client_config,
+                                                  result["config"].as<std::string>(),
+                                                  test_identifier,
+                                                  aggregator,
+                                                  trace_prefix,
+                                                  relay.index,
+                                                  reconnect_config);
 
     std::signal(SIGINT, HandleTerminateSignal);
 
+    qperf::SelfProfiler profiler(std::chrono::milliseconds(result["profile_ms"].as<std::uint32_t>()),
+                                 result["saturation"].as<double>());
+    profiler.Start();
+
     try {
         client->Connect();
     } catch (const std::exception& e) {
@@ -190,11 +293,19 @@ main(int argc, char** argv)
     }
 
     while (!terminate && !client->HandlersComplete()) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        client->PollReconnect();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
     client->Terminate();
     client->Disconnect();
+    aggregator->Stop();
+
+    client->ReportReconnects(endpoint_test_id);
+    profiler.Report(endpoint_test_id, client->GetLoad());
+    profiler.Stop();
+
+    qperf::ReportAsyncLogger(endpoint_test_id);
 
     return EXIT_SUCCESS;
 }
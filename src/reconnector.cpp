@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "reconnector.hpp"
+#include "time_source.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace qperf {
+    Reconnector::Reconnector(const ReconnectConfig& config)
+      : enabled_(config.enabled)
+      , initial_backoff_(std::max(config.initial_backoff, std::chrono::milliseconds(1)))
+      , max_backoff_(std::max(config.max_backoff, initial_backoff_))
+      , state_(State::kConnecting)
+      , connected_once_(false)
+      , backoff_(initial_backoff_)
+      , jitter_(std::random_device{}())
+      , outage_start_us_(0)
+      , attempts_(0)
+      , outages_(0)
+      , total_outage_us_(0)
+      , max_outage_us_(0)
+    {
+    }
+
+    std::chrono::milliseconds Reconnector::NextBackoff()
+    {
+        const auto backoff = backoff_;
+        backoff_ = std::min(backoff_ * 2, max_backoff_);
+
+        std::uniform_int_distribution<std::int64_t> jitter(0, backoff.count() / 2);
+        return backoff - std::chrono::milliseconds(jitter(jitter_));
+    }
+
+    bool Reconnector::Lost()
+    {
+        if (!enabled_) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> _(mutex_);
+        switch (state_) {
+            case State::kConnected:
+                outage_start_us_ = TimeSource::Instance().EpochNowUs();
+                outages_ += 1;
+                attempts_ = 0;
+                SPDLOG_WARN("Connection lost, outage {}", outages_);
+                break;
+            case State::kConnecting:
+                // A failed attempt, or the first connect of the test which is retried the same way
+                break;
+            case State::kLost:
+                return true;
+        }
+
+        state_ = State::kLost;
+        next_attempt_ = std::chrono::steady_clock::now() + NextBackoff();
+        return true;
+    }
+
+    std::uint64_t Reconnector::Ready()
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+        state_ = State::kConnected;
+        backoff_ = initial_backoff_;
+
+        if (!connected_once_) {
+            connected_once_ = true;
+            return 0;
+        }
+
+        const auto outage_start_us = outage_start_us_;
+        const auto outage_us = TimeSource::Instance().EpochNowUs() - outage_start_us;
+        total_outage_us_ += outage_us;
+        max_outage_us_ = std::max(max_outage_us_, outage_us);
+
+        // outage,outage_ms,attempts
+        SPDLOG_INFO("RECONNECT, {}, {}, {}", outages_, outage_us / 1000, attempts_);
+        return outage_start_us;
+    }
+
+    bool Reconnector::AttemptDue()
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+        const auto now = std::chrono::steady_clock::now();
+
+        if (state_ == State::kConnecting && attempts_ > 0 && now - next_attempt_ > kConnectTimeout) {
+            SPDLOG_WARN("Reconnect attempt {} timed out", attempts_);
+            state_ = State::kLost;
+            next_attempt_ = now + NextBackoff();
+        }
+
+        return state_ == State::kLost && now >= next_attempt_;
+    }
+
+    void Reconnector::Connecting()
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+        state_ = State::kConnecting;
+        attempts_ += 1;
+        next_attempt_ = std::chrono::steady_clock::now();
+        SPDLOG_INFO("Reconnect attempt {}", attempts_);
+    }
+
+    void Reconnector::Report(const std::string& endpoint_id)
+    {
+        if (!enabled_) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> _(mutex_);
+        // endpoint,outages,total_outage_ms,max_outage_ms
+        SPDLOG_INFO("RECONNECT COMPLETE, {}, {}, {}, {}",
+                    endpoint_id,
+                    outages_,
+                    total_outage_us_ / 1000,
+                    max_outage_us_ / 1000);
+    }
+} // namespace qperf
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "relay_placement.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <random>
+
+namespace qperf {
+    namespace {
+        // The relay index is a single byte in the test header
+        constexpr std::size_t kMaxRelays = 256;
+    }
+
+    std::vector<std::string> ParseRelayUris(const std::string& uris)
+    {
+        std::vector<std::string> result;
+        std::size_t start = 0;
+        while (start <= uris.size()) {
+            auto end = uris.find(',', start);
+            if (end == std::string::npos) {
+                end = uris.size();
+            }
+
+            auto uri = uris.substr(start, end - start);
+            uri.erase(0, uri.find_first_not_of(" \t"));
+            uri.erase(uri.find_last_not_of(" \t") + 1);
+            if (!uri.empty()) {
+                result.push_back(uri);
+            }
+            start = end + 1;
+        }
+
+        if (result.size() > kMaxRelays) {
+            SPDLOG_WARN("Only the first {} of {} relays are used", kMaxRelays, result.size());
+            result.resize(kMaxRelays);
+        }
+
+        return result;
+    }
+
+    RelayPlacement ParseRelayPlacement(const std::string& placement)
+    {
+        if (placement == "pinned") {
+            return RelayPlacement::kPinned;
+        }
+        if (placement == "random") {
+            return RelayPlacement::kRandom;
+        }
+        if (placement != "round_robin") {
+            SPDLOG_WARN("Invalid relay placement '{}'. Using `round_robin`", placement);
+        }
+        return RelayPlacement::kRoundRobin;
+    }
+
+    RelaySelection SelectRelay(const std::string& uris,
+                               const std::string& placement,
+                               std::uint32_t client_index,
+                               std::uint32_t pinned_index)
+    {
+        const auto relays = ParseRelayUris(uris);
+        if (relays.empty()) {
+            return { 0, uris };
+        }
+
+        std::size_t index = 0;
+        switch (ParseRelayPlacement(placement)) {
+            case RelayPlacement::kRoundRobin:
+                index = client_index % relays.size();
+                break;
+            case RelayPlacement::kPinned:
+                index = std::min<std::size_t>(pinned_index, relays.size() - 1);
+                break;
+            case RelayPlacement::kRandom: {
+                std::random_device random;
+                index = std::uniform_int_distribution<std::size_t>(0, relays.size() - 1)(random);
+            } break;
+        }
+
+        for (std::size_t i = 0; i < relays.size(); ++i) {
+            SPDLOG_INFO("RELAY, {}, {}{}", i, relays[i], i == index ? ", selected" : "");
+        }
+
+        return { static_cast<std::uint8_t>(index), relays[index] };
+    }
+} // namespace qperf
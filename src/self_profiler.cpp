@@ -0,0 +1,290 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "self_profiler.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#endif
+
+#include <algorithm>
+
+namespace qperf {
+    namespace {
+        std::uint64_t TimevalToMicroseconds(const timeval& tv)
+        {
+            return static_cast<std::uint64_t>(tv.tv_sec) * 1'000'000 + static_cast<std::uint64_t>(tv.tv_usec);
+        }
+
+#ifdef __linux__
+        /**
+         * @brief Read CPU time of a thread from /proc/self/task/<tid>/stat in microseconds
+         */
+        bool ReadThreadCpu(const std::string& tid, std::uint64_t& cpu_us)
+        {
+            std::ifstream stat_file("/proc/self/task/" + tid + "/stat");
+            std::string line;
+            if (!std::getline(stat_file, line)) {
+                return false;
+            }
+
+            // The thread name can contain spaces, fields are counted after the closing paren
+            auto pos = line.rfind(')');
+            if (pos == std::string::npos) {
+                return false;
+            }
+
+            std::istringstream fields(line.substr(pos + 2));
+            std::string field;
+            std::uint64_t utime = 0;
+            std::uint64_t stime = 0;
+            for (int i = 3; fields >> field; ++i) {
+                if (i == 14) {
+                    utime = std::stoull(field);
+                } else if (i == 15) {
+                    stime = std::stoull(field);
+                    break;
+                }
+            }
+
+            static const auto ticks_per_second = sysconf(_SC_CLK_TCK);
+            cpu_us = (utime + stime) * 1'000'000 / static_cast<std::uint64_t>(ticks_per_second);
+            return true;
+        }
+
+        /**
+         * @brief Read time spent waiting on the run queue from /proc/self/task/<tid>/schedstat
+         */
+        std::uint64_t ReadThreadRunDelay(const std::string& tid)
+        {
+            std::ifstream schedstat_file("/proc/self/task/" + tid + "/schedstat");
+            std::uint64_t run_ns = 0;
+            std::uint64_t wait_ns = 0;
+            if (!(schedstat_file >> run_ns >> wait_ns)) {
+                return 0;
+            }
+            return wait_ns / 1000;
+        }
+
+        std::string ReadThreadName(const std::string& tid)
+        {
+            std::ifstream comm_file("/proc/self/task/" + tid + "/comm");
+            std::string name;
+            std::getline(comm_file, name);
+            return name;
+        }
+#endif
+    }
+
+    SelfProfiler::SelfProfiler(std::chrono::milliseconds sample_interval, double saturation_threshold)
+      : sample_interval_(sample_interval)
+      , saturation_threshold_(saturation_threshold)
+      , terminate_(false)
+      , start_cpu_user_us_(0)
+      , start_cpu_sys_us_(0)
+      , start_vol_ctx_(0)
+      , start_invol_ctx_(0)
+      , last_cpu_us_(0)
+      , samples_(0)
+      , saturated_samples_(0)
+      , max_cpu_percent_(0.0)
+      , max_thread_cpu_percent_(0.0)
+      , total_run_delay_us_(0)
+    {
+    }
+
+    SelfProfiler::~SelfProfiler()
+    {
+        Stop();
+    }
+
+    void SelfProfiler::Start()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        start_time_ = std::chrono::steady_clock::now();
+        last_sample_time_ = start_time_;
+        start_cpu_user_us_ = TimevalToMicroseconds(usage.ru_utime);
+        start_cpu_sys_us_ = TimevalToMicroseconds(usage.ru_stime);
+        start_vol_ctx_ = usage.ru_nvcsw;
+        start_invol_ctx_ = usage.ru_nivcsw;
+        last_cpu_us_ = start_cpu_user_us_ + start_cpu_sys_us_;
+
+        sample_thread_ = std::thread([this] { SampleThread(); });
+    }
+
+    void SelfProfiler::Stop()
+    {
+        terminate_ = true;
+        if (sample_thread_.joinable()) {
+            sample_thread_.join();
+        }
+    }
+
+    void SelfProfiler::SampleThread()
+    {
+        while (!terminate_) {
+            std::this_thread::sleep_for(sample_interval_);
+            Sample(false);
+        }
+    }
+
+    void SelfProfiler::Sample(bool log)
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        auto now = std::chrono::steady_clock::now();
+        const double wall_us = std::chrono::duration<double, std::micro>(now - last_sample_time_).count();
+        if (wall_us <= 0) {
+            return;
+        }
+
+        const auto cpu_us = TimevalToMicroseconds(usage.ru_utime) + TimevalToMicroseconds(usage.ru_stime);
+        const double cpu_percent = (cpu_us - last_cpu_us_) * 100.0 / wall_us;
+        const double cores = std::max(1u, std::thread::hardware_concurrency());
+
+        samples_ += 1;
+        max_cpu_percent_ = std::max(max_cpu_percent_, cpu_percent);
+
+        const double thread_cpu_percent = SampleThreads(wall_us, log);
+        max_thread_cpu_percent_ = std::max(max_thread_cpu_percent_, thread_cpu_percent);
+
+        // A single pegged thread saturates the client even when other cores are idle
+        if (cpu_percent >= saturation_threshold_ * cores || thread_cpu_percent >= saturation_threshold_) {
+            saturated_samples_ += 1;
+            SPDLOG_WARN("PROFILE, client saturated, cpu {:.1f}% ({} cores), max thread cpu {:.1f}%",
+                        cpu_percent,
+                        cores,
+                        thread_cpu_percent);
+        }
+
+        last_cpu_us_ = cpu_us;
+        last_sample_time_ = now;
+    }
+
+    double SelfProfiler::SampleThreads([[maybe_unused]] double wall_us, [[maybe_unused]] bool log)
+    {
+        double max_thread_percent = 0.0;
+#ifdef __linux__
+        DIR* dir = opendir("/proc/self/task");
+        if (!dir) {
+            return max_thread_percent;
+        }
+
+        std::map<int, ThreadSample> thread_samples;
+        while (auto* entry = readdir(dir)) {
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
+
+            const std::string tid = entry->d_name;
+            ThreadSample sample{ 0, 0 };
+            if (!ReadThreadCpu(tid, sample.cpu_us)) {
+                continue;
+            }
+            sample.run_delay_us = ReadThreadRunDelay(tid);
+
+            const int id = std::stoi(tid);
+            auto last = last_thread_samples_.find(id);
+            if (last != last_thread_samples_.end()) {
+                const double thread_percent = (sample.cpu_us - last->second.cpu_us) * 100.0 / wall_us;
+                total_run_delay_us_ += sample.run_delay_us - last->second.run_delay_us;
+
+                if (thread_percent > max_thread_cpu_percent_) {
+                    SPDLOG_DEBUG("PROFILE, new max thread cpu {:.1f}% thread {} ({})",
+                                 thread_percent,
+                                 tid,
+                                 ReadThreadName(tid));
+                }
+                max_thread_percent = std::max(max_thread_percent, thread_percent);
+
+                if (log) {
+                    SPDLOG_INFO("PROFILE THREAD, {}, {}, {:.1f}", tid, ReadThreadName(tid), thread_percent);
+                }
+            }
+
+            thread_samples.emplace(id, sample);
+        }
+        closedir(dir);
+
+        last_thread_samples_ = std::move(thread_samples);
+#endif
+        return max_thread_percent;
+    }
+
+    bool SelfProfiler::Report(const std::string& endpoint_id, const ClientLoad& load)
+    {
+        Sample(true);
+
+        std::lock_guard<std::mutex> _(mutex_);
+
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        const auto now = std::chrono::steady_clock::now();
+        const double wall_us = std::chrono::duration<double, std::micro>(now - start_time_).count();
+        const auto cpu_user_us = TimevalToMicroseconds(usage.ru_utime) - start_cpu_user_us_;
+        const auto cpu_sys_us = TimevalToMicroseconds(usage.ru_stime) - start_cpu_sys_us_;
+        const auto vol_ctx = usage.ru_nvcsw - start_vol_ctx_;
+        const auto invol_ctx = usage.ru_nivcsw - start_invol_ctx_;
+        const double avg_cpu_percent = wall_us > 0 ? (cpu_user_us + cpu_sys_us) * 100.0 / wall_us : 0.0;
+        const double cpu_us_per_object =
+          load.objects > 0 ? static_cast<double>(cpu_user_us + cpu_sys_us) / load.objects : 0.0;
+        const double avg_wakeup_us =
+          load.wakeup.samples > 0 ? static_cast<double>(load.wakeup.total_lateness_us) / load.wakeup.samples : 0.0;
+
+        // More than 1% of the publish wake-ups missing their schedule means pacing was not under control
+        const bool missed_schedule = load.wakeup.late_wakeups * 100 > load.wakeup.samples;
+        const bool valid = saturated_samples_ == 0 && !missed_schedule;
+
+        SPDLOG_INFO("--------------------------------------------");
+        SPDLOG_INFO("Client Profile");
+        SPDLOG_INFO("             CPU user/sys (ms) {:.1f}/{:.1f}", cpu_user_us / 1000.0, cpu_sys_us / 1000.0);
+        SPDLOG_INFO("                 avg/max CPU % {:.1f}/{:.1f}", avg_cpu_percent, max_cpu_percent_);
+        SPDLOG_INFO("              max thread CPU % {:.1f}", max_thread_cpu_percent_);
+        SPDLOG_INFO("   context switches vol/invol {}/{}", vol_ctx, invol_ctx);
+        SPDLOG_INFO("         scheduler delay (ms) {:.1f}", total_run_delay_us_ / 1000.0);
+        SPDLOG_INFO("                       objects {}", load.objects);
+        SPDLOG_INFO("           CPU per object (us) {:.3f}", cpu_us_per_object);
+        SPDLOG_INFO("   wakeup lateness avg/max (us) {:.1f}/{}", avg_wakeup_us, load.wakeup.max_lateness_us);
+        SPDLOG_INFO("                  late wakeups {} of {}", load.wakeup.late_wakeups, load.wakeup.samples);
+        SPDLOG_INFO("             saturated samples {} of {}", saturated_samples_, samples_);
+        SPDLOG_INFO("                       results {}", valid ? "VALID" : "INVALID - client saturated");
+        SPDLOG_INFO("--------------------------------------------");
+
+        // endpoint_id,cpu_user_ms,cpu_sys_ms,avg_cpu,max_cpu,max_thread_cpu,vol_ctx,invol_ctx,sched_delay_ms,
+        //       objects,cpu_us_per_object,avg_wakeup_us,max_wakeup_us,late_wakeups,saturated_samples,samples,valid
+        SPDLOG_INFO("PROFILE COMPLETE, {}, {:.1f}, {:.1f}, {:.1f}, {:.1f}, {:.1f}, {}, {}, {:.1f}, {}, {:.3f}, {:.1f}, "
+                    "{}, {}, {}, {}, {}",
+                    endpoint_id,
+                    cpu_user_us / 1000.0,
+                    cpu_sys_us / 1000.0,
+                    avg_cpu_percent,
+                    max_cpu_percent_,
+                    max_thread_cpu_percent_,
+                    vol_ctx,
+                    invol_ctx,
+                    total_run_delay_us_ / 1000.0,
+                    load.objects,
+                    cpu_us_per_object,
+                    avg_wakeup_us,
+                    load.wakeup.max_lateness_us,
+                    load.wakeup.late_wakeups,
+                    saturated_samples_,
+                    samples_,
+                    valid ? "VALID" : "INVALID");
+
+        return valid;
+    }
+} // namespace qperf
@@ -0,0 +1,183 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "size_model.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace qperf {
+    namespace {
+        // Bounds the memory of very long or very fast tracks, longer tests reuse the schedule
+        constexpr std::size_t kMaxScheduleLength = 1 << 20;
+
+        // Default bound of heavy tailed sizes relative to the configured sizes, keeps scene cuts of keyframes
+        constexpr double kDefaultMaxSizeFactor = 8.0;
+
+        SizeModel ParseSizeModel(const std::string& value)
+        {
+            if (value == "normal") {
+                return SizeModel::kNormal;
+            }
+            if (value == "lognormal") {
+                return SizeModel::kLogNormal;
+            }
+            if (value == "pareto") {
+                return SizeModel::kPareto;
+            }
+            if (value == "gop") {
+                return SizeModel::kGop;
+            }
+            if (value != "constant") {
+                SPDLOG_WARN("Invalid size_model '{}'. Using default `constant`", value);
+            }
+            return SizeModel::kConstant;
+        }
+
+        /**
+         * @brief Log-normal sample with the given mean
+         */
+        double LogNormal(std::mt19937_64& rng, double mean, double sigma)
+        {
+            if (sigma <= 0.0 || mean <= 0.0) {
+                return mean;
+            }
+
+            std::lognormal_distribution<double> distribution(std::log(mean) - sigma * sigma / 2, sigma);
+            return distribution(rng);
+        }
+    }
+
+    bool PopulateSizeModel(const ini::IniSection& section, SizeModelConfig& config)
+    {
+        config.model = ParseSizeModel(ValueOrDefault<std::string>(section, "size_model", "constant"));
+        config.seed = ValueOrDefault<std::uint64_t>(section, "size_seed", 1);
+        config.size_cv = ValueOrDefault<double>(section, "size_cv", 0.2);
+        config.size_sigma = ValueOrDefault<double>(section, "size_sigma", 0.5);
+        config.pareto_alpha = ValueOrDefault<double>(section, "pareto_alpha", 2.5);
+        config.gop_pattern = ValueOrDefault<std::string>(section, "gop_pattern", "P");
+        config.b_frame_ratio = ValueOrDefault<double>(section, "b_frame_ratio", 0.5);
+        config.scene_cut_rate = ValueOrDefault<double>(section, "scene_cut_rate", 0.0);
+        config.scene_cut_scale = ValueOrDefault<double>(section, "scene_cut_scale", 4.0);
+        config.max_object_size = ValueOrDefault<std::uint32_t>(section, "max_object_size", 0);
+
+        if (config.model == SizeModel::kPareto && config.pareto_alpha <= 1.0) {
+            SPDLOG_WARN("pareto_alpha {} has no finite mean. Using 1.1", config.pareto_alpha);
+            config.pareto_alpha = 1.1;
+        }
+
+        if (config.gop_pattern.empty() ||
+            config.gop_pattern.find_first_not_of("PB") != std::string::npos) {
+            SPDLOG_WARN("Invalid gop_pattern '{}', only P and B frames may follow the I frame. Using `P`",
+                        config.gop_pattern);
+            config.gop_pattern = "P";
+        }
+
+        return true;
+    }
+
+    SizeSchedule SizeSchedule::Build(const SizeModelConfig& size_config, const PerfConfig& perf_config)
+    {
+        SizeSchedule schedule;
+        if (size_config.model == SizeModel::kConstant) {
+            return schedule;
+        }
+
+        const auto objects_per_group = std::max<std::uint32_t>(perf_config.objects_per_group, 1);
+        const auto interval = std::max(perf_config.transmit_interval, 0.001);
+
+        // Whole groups, so a wrapped schedule and a new group request both land on a group start size
+        const auto objects = static_cast<std::size_t>(perf_config.total_transmit_time / interval) + 1;
+        const auto groups = std::clamp<std::size_t>((objects + objects_per_group - 1) / objects_per_group,
+                                                    1,
+                                                    std::max<std::size_t>(kMaxScheduleLength / objects_per_group, 1));
+        const auto length = groups * objects_per_group;
+
+        // Sizes never drop below the test header so every object still carries its timestamp
+        const double min_size = sizeof(ObjectTestHeader);
+        const double max_size =
+          size_config.max_object_size
+            ? size_config.max_object_size
+            : kDefaultMaxSizeFactor * std::max(perf_config.first_object_size, perf_config.object_size);
+
+        std::mt19937_64 rng(size_config.seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        schedule.sizes_.reserve(length);
+        for (std::size_t i = 0; i < length; ++i) {
+            const auto object_id = i % objects_per_group;
+            const double mean = object_id == 0 ? perf_config.first_object_size : perf_config.object_size;
+            double size = mean;
+
+            switch (size_config.model) {
+                case SizeModel::kNormal: {
+                    // The distribution requires a positive stddev, no variation is the mean size
+                    const double stddev = mean * size_config.size_cv;
+                    if (stddev > 0.0) {
+                        size = std::normal_distribution<double>(mean, stddev)(rng);
+                    }
+                    break;
+                }
+                case SizeModel::kLogNormal:
+                    size = LogNormal(rng, mean, size_config.size_sigma);
+                    break;
+                case SizeModel::kPareto: {
+                    // Scale chosen so the distribution mean is the configured size
+                    const auto alpha = size_config.pareto_alpha;
+                    const auto scale = mean * (alpha - 1) / alpha;
+                    size = scale / std::pow(1.0 - uniform(rng), 1.0 / alpha);
+                    break;
+                }
+                case SizeModel::kGop: {
+                    double frame_mean = mean;
+                    if (object_id != 0) {
+                        const auto& pattern = size_config.gop_pattern;
+                        if (pattern[(object_id - 1) % pattern.size()] == 'B') {
+                            frame_mean = mean * size_config.b_frame_ratio;
+                        }
+                    }
+
+                    size = LogNormal(rng, frame_mean, size_config.size_sigma);
+
+                    // A scene cut is coded like an I frame wherever it lands in the group
+                    if (object_id != 0 && uniform(rng) * 100.0 < size_config.scene_cut_rate) {
+                        size *= size_config.scene_cut_scale;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+
+            const auto bounded = static_cast<std::uint32_t>(std::clamp(std::round(size), min_size, max_size));
+            schedule.sizes_.push_back(bounded);
+            schedule.max_size_ = std::max(schedule.max_size_, bounded);
+        }
+
+        auto sizes = schedule.sizes_;
+        const auto typical = sizes.begin() + static_cast<std::ptrdiff_t>(sizes.size() * 99 / 100);
+        std::nth_element(sizes.begin(), typical, sizes.end());
+        schedule.typical_size_ = *typical;
+
+        return schedule;
+    }
+
+    std::string SizeModelToString(SizeModel model)
+    {
+        switch (model) {
+            case SizeModel::kNormal:
+                return "normal";
+            case SizeModel::kLogNormal:
+                return "lognormal";
+            case SizeModel::kPareto:
+                return "pareto";
+            case SizeModel::kGop:
+                return "gop";
+            default:
+                return "constant";
+        }
+    }
+} // namespace qperf
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "subscriber_aggregator.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace qperf {
+    namespace {
+        // Short enough to keep the record queues far from full at the highest object rates tested
+        constexpr auto kIdleBackoff = std::chrono::microseconds(200);
+    }
+
+    SubscriberAggregator::SubscriberAggregator(std::size_t num_threads)
+      : terminate_(false)
+      , next_worker_(0)
+    {
+        const auto count = std::max<std::size_t>(num_threads, 1);
+        for (std::size_t i = 0; i < count; ++i) {
+            workers_.emplace_back(std::make_unique<Worker>());
+        }
+
+        for (auto& worker : workers_) {
+            worker->thread = std::thread([this, &worker = *worker] { WorkerThread(worker); });
+        }
+    }
+
+    SubscriberAggregator::~SubscriberAggregator()
+    {
+        Stop();
+    }
+
+    void SubscriberAggregator::Register(const std::shared_ptr<PerfSubscribeTrackHandler>& handler)
+    {
+        auto& worker = *workers_[next_worker_.fetch_add(1) % workers_.size()];
+        std::lock_guard<std::mutex> _(worker.handlers_mutex);
+        worker.handlers.push_back(handler);
+    }
+
+    void SubscriberAggregator::Stop()
+    {
+        terminate_ = true;
+        for (auto& worker : workers_) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    }
+
+    std::size_t SubscriberAggregator::Drain(Worker& worker)
+    {
+        std::lock_guard<std::mutex> _(worker.handlers_mutex);
+        std::size_t processed = 0;
+        for (auto& handler : worker.handlers) {
+            processed += handler->ProcessRecords();
+        }
+        return processed;
+    }
+
+    void SubscriberAggregator::WorkerThread(Worker& worker)
+    {
+        while (!terminate_) {
+            if (Drain(worker) == 0) {
+                std::this_thread::sleep_for(kIdleBackoff);
+            }
+        }
+
+        // Final pass so objects received before stop are counted
+        Drain(worker);
+    }
+} // namespace qperf
@@ -3,36 +3,88 @@
 
 #include "subscriber_track_handler.hpp"
 #include "qperf.hpp"
+#include "time_source.hpp"
 
 #include <cxxopts.hpp>
 #include <quicr/client.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cctype>
 #include <chrono>
 #include <condition_variable>
 #include <cstdlib>
 #include <functional>
+#include <mutex>
 #include <stack>
 #include <string>
 #include <thread>
+#include <utility>
 
 namespace qperf {
 
     std::atomic_bool terminate = false;
 
+    namespace {
+        // Objects between refreshes of the latency spike threshold
+        constexpr std::uint64_t kSpikeThresholdObjects = 256;
+
+        // An object this many times the mean size of the other objects in the window is a burst, e.g. a keyframe
+        constexpr std::uint64_t kBurstFactor = 2;
+
+        /**
+         * @brief Objects skipped between the expected object and a received one at or after it
+         * @details Groups are objects_per_group long unless the publisher sent the length of the group the
+         *          received object follows, e.g. a group ended early for a new group request.
+         * @param previous_group_objects    Objects of the group before group, objects_per_group when unknown
+         */
+        std::uint64_t ObjectsMissed(std::uint64_t expected_group,
+                                    std::uint64_t expected_object,
+                                    std::uint64_t group,
+                                    std::uint64_t object,
+                                    std::uint64_t objects_per_group,
+                                    std::uint64_t previous_group_objects)
+        {
+            if (group == expected_group) {
+                return object - expected_object;
+            }
+
+            const auto ended_objects = group == expected_group + 1 ? previous_group_objects : objects_per_group;
+            return (ended_objects > expected_object ? ended_objects - expected_object : 0) +
+                   (group - expected_group - 1) * objects_per_group + object;
+        }
+
+        std::uint64_t PreviousGroupObjects(const ObjectRecord& record, std::uint64_t objects_per_group)
+        {
+            return record.test.previous_group_objects ? record.test.previous_group_objects : objects_per_group;
+        }
+
+        bool ObjectBefore(std::uint64_t group, std::uint64_t object, std::uint64_t other_group, std::uint64_t other)
+        {
+            return group < other_group || (group == other_group && object < other);
+        }
+    }
+
     /**
      * @brief  Subscribe track handler
      * @details Subscribe track handler used for the subscribe command line option.
      */
-    PerfSubscribeTrackHandler::PerfSubscribeTrackHandler(const PerfConfig& perf_config, std::uint32_t test_identifier)
+    PerfSubscribeTrackHandler::PerfSubscribeTrackHandler(const PerfConfig& perf_config,
+                                                         std::uint32_t test_identifier,
+                                                         const std::string& trace_prefix,
+                                                         LayerSchedule layer_schedule)
       : SubscribeTrackHandler(perf_config.full_track_name,
                               perf_config.priority,
                               quicr::messages::GroupOrder::kOriginalPublisherOrder,
-                              quicr::messages::FilterType::kLargestObject)
+                              perf_config.filter_type)
       , terminate_(false)
       , perf_config_(perf_config)
+      , layer_schedule_(std::move(layer_schedule))
+      , objects_per_group_(layer_schedule_.Empty() ? std::max<std::uint32_t>(perf_config.objects_per_group, 1)
+                                                   : layer_schedule_.ObjectsPerGroup())
+      , layer_stats_(layer_schedule_.Layers())
       , first_pass_(true)
       , last_bytes_(0)
       , local_now_(0)
@@ -54,16 +106,64 @@ namespace qperf {
       , min_object_arrival_delta_(std::numeric_limits<std::int64_t>::max())
       , avg_object_arrival_delta_(0.0)
       , total_arrival_delta_(0)
+      , records_(kRecordQueueSize)
+      , records_dropped_(0)
+      , pending_dropped_(0)
+      , expected_group_id_(0)
+      , expected_object_id_(0)
+      , lost_objects_(0)
+      , reordered_objects_(0)
+      , priority_inversions_(0)
+      , age_buckets_{}
+      , stale_objects_(0)
+      , stale_bytes_(0)
+      , ttl_lost_objects_(0)
+      , last_publish_time_(0)
+      , integrity_checked_(0)
+      , integrity_corrupt_(0)
+      , integrity_size_mismatch_(0)
+      , join_time_(0)
+      , first_object_time_(0)
+      , first_group_start_time_(0)
+      , catchup_objects_(0)
+      , catchup_bytes_(0)
+      , catchup_first_time_(0)
+      , catchup_last_time_(0)
+      , outage_start_time_(0)
+      , resubscribe_time_(0)
+      , outages_(0)
+      , outage_lost_objects_(0)
+      , max_restore_time_(0)
+      , incomplete_groups_(0)
+      , recent_sizes_{}
+      , recent_bytes_(0)
+      , position_objects_(0)
+      , total_recent_bytes_(0)
+      , spike_threshold_(0)
+      , spikes_(0)
+      , burst_spikes_(0)
+      , spike_recent_bytes_(0)
+      , sync_track_(0)
+      , publisher_relay_index_(0)
     {
+        if (!trace_prefix.empty()) {
+            std::string file_name = perf_config_.test_name;
+            std::replace_if(file_name.begin(), file_name.end(), [](unsigned char c) { return !std::isalnum(c); }, '_');
+            trace_path_ = fmt::format("{}_{}_{}.qtrace", trace_prefix, test_identifier_, file_name);
+        }
     }
 
     std::shared_ptr<PerfSubscribeTrackHandler> PerfSubscribeTrackHandler::Create(const std::string& section_name,
                                                                                  ini::IniFile& inif,
-                                                                                 std::uint32_t instance_id)
+                                                                                 std::uint32_t instance_id,
+                                                                                 const std::string& trace_prefix,
+                                                                                 std::uint8_t relay_index)
     {
         PerfConfig perf_config;
         PopulateScenarioFields(section_name, instance_id, inif, perf_config);
-        return std::shared_ptr<PerfSubscribeTrackHandler>(new PerfSubscribeTrackHandler(perf_config, instance_id));
+        perf_config.relay_index = relay_index;
+        return std::shared_ptr<PerfSubscribeTrackHandler>(new PerfSubscribeTrackHandler(
+          perf_config, instance_id, trace_prefix, LayerSchedule::Build(inif[section_name], perf_config)));
     }
 
     void PerfSubscribeTrackHandler::StatusChanged(Status status)
@@ -112,11 +212,422 @@ namespace qperf {
     void PerfSubscribeTrackHandler::ObjectReceived(const quicr::ObjectHeaders& object_header,
                                                    quicr::BytesSpan data_span)
     {
-        auto received_time = std::chrono::system_clock::now();
-        local_now_ = std::chrono::time_point_cast<std::chrono::microseconds>(received_time).time_since_epoch().count();
+        // Runs on the transport receive thread, only capture what the aggregator needs and return
+        ObjectRecord record;
+        record.received_time = TimeSource::Instance().EpochNowUs();
+        record.group_id = object_header.group_id;
+        record.object_id = object_header.object_id;
+        record.size = data_span.size();
+        record.integrity = IntegrityResult::kUnchecked;
+        record.priority_inverted = false;
+        record.dropped_before = pending_dropped_;
+        memset(&record.test, '\0', sizeof(record.test));
+
+        if (!data_span.empty()) {
+            auto header_bytes_to_copy = data_span.size() < sizeof(ObjectTestHeader) ? sizeof(record.test.test_mode)
+                                                                                     : sizeof(ObjectTestHeader);
+            if (data_span[0] == static_cast<std::uint8_t>(qperf::TestMode::kComplete) &&
+                data_span.size() >= sizeof(ObjectTestComplete)) {
+                header_bytes_to_copy = sizeof(ObjectTestComplete);
+            }
+            memcpy(&record.test, data_span.data(), header_bytes_to_copy);
+
+            // Needs the payload, so it is checked here instead of on the aggregator
+            if (record.test.test_mode == qperf::TestMode::kRunning) {
+                record.integrity = VerifyObject(perf_config_.integrity,
+                                                object_header.group_id,
+                                                object_header.object_id,
+                                                data_span.data(),
+                                                data_span.size());
+
+                // Arrival order across tracks is only known here, the aggregator threads reorder it
+                auto priority = perf_config_.priority;
+                if (!layer_schedule_.Empty()) {
+                    priority = layer_schedule_.Layer(layer_schedule_.At(object_header.object_id).layer).priority;
+                }
+                record.priority_inverted = PriorityTracker::Instance().Received(priority, record.test.time);
+            }
+        }
+
+        // The test complete record ends the test, it waits for room instead of being dropped
+        if (record.test.test_mode != qperf::TestMode::kRunning) {
+            while (!records_.TryPush(record)) {
+                if (terminate_) {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+            pending_dropped_ = 0;
+            return;
+        }
+
+        if (!records_.TryPush(record)) {
+            records_dropped_.fetch_add(1, std::memory_order_relaxed);
+            pending_dropped_ += 1;
+            return;
+        }
+        pending_dropped_ = 0;
+    }
+
+    std::size_t PerfSubscribeTrackHandler::ProcessRecords()
+    {
+        std::size_t processed = 0;
+        ObjectRecord record;
+        while (!terminate_ && records_.TryPop(record)) {
+            ProcessRecord(record);
+            processed += 1;
+        }
+        return processed;
+    }
 
-        total_objects_ += 1;
-        total_bytes_ += data_span.size();
+    void PerfSubscribeTrackHandler::TrackLoss(const ObjectRecord& record)
+    {
+        const auto group_id = record.group_id;
+        const auto object_id = record.object_id;
+
+        if (first_pass_) {
+            expected_group_id_ = group_id;
+            expected_object_id_ = object_id + 1;
+            return;
+        }
+
+        if (ObjectBefore(group_id, object_id, expected_group_id_, expected_object_id_)) {
+            // Late object that was already counted as lost, anything else is a duplicate
+            if (missing_objects_.erase({ group_id, object_id }) > 0) {
+                reordered_objects_ += 1;
+                if (lost_objects_ > 0) {
+                    lost_objects_ -= 1;
+                }
+            }
+            return;
+        }
+
+        // Gaps across groups count the objects left of the expected group and of any group skipped. Records the
+        // ring dropped before this one are in the gap but were delivered, they are reported as dropped records
+        const auto missed = ObjectsMissed(expected_group_id_,
+                                          expected_object_id_,
+                                          group_id,
+                                          object_id,
+                                          objects_per_group_,
+                                          PreviousGroupObjects(record, objects_per_group_));
+        lost_objects_ += missed - std::min<std::uint64_t>(missed, record.dropped_before);
+        if (missed > 0) {
+            RememberMissing(record);
+        }
+        expected_group_id_ = group_id;
+        expected_object_id_ = object_id + 1;
+    }
+
+    void PerfSubscribeTrackHandler::RememberMissing(const ObjectRecord& record)
+    {
+        // Walk the gap back from the received object, only the latest kMissingWindow objects are kept
+        auto group_id = record.group_id;
+        auto object_id = record.object_id;
+        for (std::size_t remembered = 0; remembered < kMissingWindow;) {
+            if (object_id == 0) {
+                if (group_id <= expected_group_id_) {
+                    break;
+                }
+                group_id -= 1;
+                object_id = group_id + 1 == record.group_id ? PreviousGroupObjects(record, objects_per_group_)
+                                                            : objects_per_group_;
+                continue;
+            }
+
+            object_id -= 1;
+            if (group_id == expected_group_id_ && object_id < expected_object_id_) {
+                break;
+            }
+            missing_objects_.emplace(group_id, object_id);
+            remembered += 1;
+        }
+
+        while (missing_objects_.size() > kMissingWindow) {
+            missing_objects_.erase(missing_objects_.begin());
+        }
+    }
+
+    void PerfSubscribeTrackHandler::TrackStale(const ObjectRecord& record, std::uint64_t lost_objects)
+    {
+        const std::uint64_t ttl = static_cast<std::uint64_t>(record.test.ttl) * 1000;
+        const auto last_publish_time = std::exchange(last_publish_time_, record.test.time);
+        if (ttl == 0) {
+            return;
+        }
+
+        const auto age = record.received_time > record.test.time ? record.received_time - record.test.time : 0;
+        age_buckets_[std::min<std::uint64_t>(age * (kAgeBuckets - 1) / ttl, kAgeBuckets - 1)] += 1;
+
+        if (age >= ttl) {
+            stale_objects_ += 1;
+            stale_bytes_ += record.size;
+        }
+
+        // The lost objects were published after the previous object. When that object would have been past
+        // its TTL by the time delivery resumed, the relay expired the gap rather than the transport losing it.
+        if (lost_objects > 0 && last_publish_time != 0 && record.received_time >= last_publish_time + ttl) {
+            ttl_lost_objects_ += lost_objects;
+        }
+    }
+
+    void PerfSubscribeTrackHandler::TrackLayer(const ObjectRecord& record)
+    {
+        const auto& slot = layer_schedule_.At(record.object_id);
+        auto& layer = layer_stats_[slot.layer];
+
+        layer.latency.RecordSigned(static_cast<std::int64_t>(record.received_time - record.test.time));
+        layer.objects += 1;
+
+        if (layer.objects > 1 &&
+            ObjectBefore(record.group_id, slot.layer_index, layer.expected_group_id, layer.expected_index)) {
+            layer.reordered_objects += 1;
+            if (layer.lost_objects > 0) {
+                layer.lost_objects -= 1;
+            }
+            return;
+        }
+
+        if (layer.objects > 1) {
+            // A group cut short has only the layer's objects of the slots published before the cut
+            const auto layer_objects_per_group = layer_schedule_.LayerObjectsPerGroup(slot.layer);
+            const auto previous_group_objects =
+              record.test.previous_group_objects
+                ? layer_schedule_.LayerObjectsIn(slot.layer, record.test.previous_group_objects)
+                : layer_objects_per_group;
+            layer.lost_objects += ObjectsMissed(layer.expected_group_id,
+                                                layer.expected_index,
+                                                record.group_id,
+                                                slot.layer_index,
+                                                layer_objects_per_group,
+                                                previous_group_objects);
+        }
+
+        layer.expected_group_id = record.group_id;
+        layer.expected_index = slot.layer_index + 1;
+    }
+
+    void PerfSubscribeTrackHandler::ReportLayers()
+    {
+        for (std::size_t i = 0; i < layer_stats_.size(); ++i) {
+            const auto& layer = layer_stats_[i];
+
+            // id,test_name,layer,priority,objects,lost_objects,reordered_objects,p50,p99,max transmit latency (us)
+            SPDLOG_INFO("OR LAYER, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+                        test_identifier_,
+                        perf_config_.test_name,
+                        i,
+                        layer_schedule_.Layer(i).priority,
+                        layer.objects,
+                        layer.lost_objects,
+                        layer.reordered_objects,
+                        layer.latency.Percentile(50),
+                        layer.latency.Percentile(99),
+                        layer.latency.Max());
+        }
+    }
+
+    void PerfSubscribeTrackHandler::TrackGroup(const ObjectRecord& record)
+    {
+        // The group the subscription started in is only partly delivered
+        if (!first_group_id_) {
+            first_group_id_ = record.group_id;
+        }
+        if (record.group_id <= *first_group_id_) {
+            return;
+        }
+
+        // A group that ended early completes with the length its successor reports
+        if (record.test.previous_group_objects != 0) {
+            auto& previous = groups_[(record.group_id - 1) % kGroupWindow];
+            if (previous.group_id == record.group_id - 1) {
+                CompleteGroup(previous, record.test.previous_group_objects);
+            }
+        }
+
+        auto& group = groups_[record.group_id % kGroupWindow];
+        if (group.group_id != record.group_id) {
+            if (record.group_id < group.group_id) {
+                // Late object of a group that already left the window
+                return;
+            }
+
+            FinishGroup(group);
+            group = GroupProgress{ record.group_id, 0, 0, 0, false };
+        }
+
+        if (group.complete) {
+            return;
+        }
+
+        group.objects += 1;
+        group.last_arrival_time = std::max(group.last_arrival_time, record.received_time);
+        if (record.object_id == 0) {
+            group.first_publish_time = record.test.time;
+        }
+
+        // Replayed trace groups vary in length, they complete once the next group reports the length
+        if (perf_config_.trace_file.empty()) {
+            CompleteGroup(group, objects_per_group_);
+        }
+    }
+
+    void PerfSubscribeTrackHandler::CompleteGroup(GroupProgress& group, std::uint64_t group_objects)
+    {
+        if (group.complete || group.objects < group_objects || group.first_publish_time == 0) {
+            return;
+        }
+
+        group.complete = true;
+        group_latency_.RecordSigned(static_cast<std::int64_t>(group.last_arrival_time - group.first_publish_time));
+    }
+
+    void PerfSubscribeTrackHandler::FinishGroup(const GroupProgress& group)
+    {
+        if (group.objects == 0 || group.complete) {
+            return;
+        }
+
+        incomplete_groups_ += 1;
+        SPDLOG_DEBUG("OR, {}, {} - incomplete group {}, {} of {} objects",
+                     test_identifier_,
+                     perf_config_.test_name,
+                     group.group_id,
+                     group.objects,
+                     objects_per_group_);
+    }
+
+    void PerfSubscribeTrackHandler::TrackPosition(const ObjectRecord& record)
+    {
+        const auto latency = static_cast<std::int64_t>(record.received_time - record.test.time);
+        const auto bucket = record.object_id == 0 ? 0 : (record.object_id < 10 ? 1 : 2);
+        position_latency_[bucket].RecordSigned(latency);
+
+        // Bytes of this and the preceding objects of the track, what was queued ahead of or with it
+        auto& oldest = recent_sizes_[position_objects_ % kSpikeWindow];
+        recent_bytes_ += record.size - oldest;
+        oldest = record.size;
+        position_objects_ += 1;
+        total_recent_bytes_ += recent_bytes_;
+
+        if (position_objects_ % kSpikeThresholdObjects == 0) {
+            Histogram all;
+            for (const auto& histogram : position_latency_) {
+                all.Merge(histogram);
+            }
+            spike_threshold_ = all.Percentile(99);
+        }
+
+        if (spike_threshold_ == 0 || latency <= static_cast<std::int64_t>(spike_threshold_)) {
+            return;
+        }
+
+        // A burst within the window points at the object sizes, otherwise at the relay or network
+        spikes_ += 1;
+        spike_recent_bytes_ += recent_bytes_;
+
+        const auto window = std::min<std::uint64_t>(position_objects_, kSpikeWindow);
+        const auto largest = *std::max_element(recent_sizes_.begin(), recent_sizes_.begin() + window);
+        if (window > 1 && largest * (window - 1) > kBurstFactor * (recent_bytes_ - largest)) {
+            burst_spikes_ += 1;
+        }
+    }
+
+    void PerfSubscribeTrackHandler::ReportPositions()
+    {
+        // id,test_name,objects,p50,p99,max of object 0, of objects 1-9 and of objects 10+ (us)
+        SPDLOG_INFO("OR POSITION, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+                    test_identifier_,
+                    perf_config_.test_name,
+                    position_latency_[0].Count(),
+                    position_latency_[0].Percentile(50),
+                    position_latency_[0].Percentile(99),
+                    position_latency_[0].Max(),
+                    position_latency_[1].Count(),
+                    position_latency_[1].Percentile(50),
+                    position_latency_[1].Percentile(99),
+                    position_latency_[1].Max(),
+                    position_latency_[2].Count(),
+                    position_latency_[2].Percentile(50),
+                    position_latency_[2].Percentile(99),
+                    position_latency_[2].Max());
+
+        // id,test_name,spike_threshold_us,spikes,burst_spikes,other_spikes,avg bytes before a spike,
+        //       avg bytes before any object
+        SPDLOG_INFO("OR SPIKE, {}, {}, {}, {}, {}, {}, {:.0f}, {:.0f}",
+                    test_identifier_,
+                    perf_config_.test_name,
+                    spike_threshold_,
+                    spikes_,
+                    burst_spikes_,
+                    spikes_ - burst_spikes_,
+                    spikes_ ? double(spike_recent_bytes_) / spikes_ : 0.0,
+                    position_objects_ ? double(total_recent_bytes_) / position_objects_ : 0.0);
+    }
+
+    void PerfSubscribeTrackHandler::TrackJoin(const ObjectRecord& record)
+    {
+        const std::uint64_t join_time = join_time_;
+
+        if (first_object_time_ == 0) {
+            first_object_time_ = record.received_time;
+        }
+
+        if (first_group_start_time_ == 0 && record.object_id == 0) {
+            first_group_start_time_ = record.received_time;
+        }
+
+        if (join_time != 0 && record.test.time < join_time) {
+            if (catchup_objects_ == 0) {
+                catchup_first_time_ = record.received_time;
+            }
+            catchup_objects_ += 1;
+            catchup_bytes_ += record.size;
+            catchup_last_time_ = record.received_time;
+        }
+    }
+
+    void PerfSubscribeTrackHandler::Resubscribing(std::uint64_t outage_start_us)
+    {
+        outage_start_time_ = outage_start_us;
+        resubscribe_time_.store(TimeSource::Instance().EpochNowUs(), std::memory_order_release);
+    }
+
+    void PerfSubscribeTrackHandler::TrackRestore(const ObjectRecord& record, std::uint64_t resubscribe_time)
+    {
+        const auto lost_objects =
+          ObjectBefore(record.group_id, record.object_id, expected_group_id_, expected_object_id_)
+            ? 0
+            : ObjectsMissed(expected_group_id_,
+                            expected_object_id_,
+                            record.group_id,
+                            record.object_id,
+                            objects_per_group_,
+                            PreviousGroupObjects(record, objects_per_group_));
+        const auto restore_time = record.received_time - outage_start_time_;
+
+        outages_ += 1;
+        outage_lost_objects_ += lost_objects;
+        max_restore_time_ = std::max(max_restore_time_, restore_time);
+
+        // id,test_name,outage,restore_us,resubscribe_us,lost_objects
+        SPDLOG_INFO("OR RESTORED, {}, {}, {}, {}, {}, {}",
+                    test_identifier_,
+                    perf_config_.test_name,
+                    outages_,
+                    restore_time,
+                    record.received_time - resubscribe_time,
+                    lost_objects);
+
+        // A newer outage may have been marked meanwhile, it keeps its own resubscribe time
+        resubscribe_time_.compare_exchange_strong(resubscribe_time, 0);
+    }
+
+    void PerfSubscribeTrackHandler::ProcessRecord(const ObjectRecord& record)
+    {
+        local_now_ = record.received_time;
+
+        total_objects_.fetch_add(1, std::memory_order_relaxed);
+        total_bytes_ += record.size;
 
         if (first_pass_) {
 
@@ -124,24 +635,19 @@ namespace qperf {
             start_data_time_ = local_now_;
         }
 
-        memcpy(&test_mode_, data_span.data(), sizeof(std::uint8_t));
+        const auto test_mode = record.test.test_mode;
+        test_mode_ = test_mode;
 
-        if (test_mode_ == qperf::TestMode::kRunning) {
-
-            qperf::ObjectTestHeader test_header;
-            memset(&test_header, '\0', sizeof(test_header));
-            memcpy(&test_header,
-                   &data_span[0],
-                   data_span.size() < sizeof(test_header) ? sizeof(test_header.test_mode) : sizeof(test_header));
+        if (test_mode == qperf::TestMode::kRunning) {
 
-            auto remote_now = test_header.time;
+            auto remote_now = record.test.time;
             std::int64_t transmit_delta = local_now_ - remote_now;
             std::int64_t arrival_delta = local_now_ - last_local_now_;
 
             if (transmit_delta <= 0) {
                 SPDLOG_INFO("-- negative/zero transmit delta (check ntp) -- {} {} {} {} {}",
-                            object_header.group_id,
-                            object_header.object_id,
+                            record.group_id,
+                            record.object_id,
                             local_now_,
                             remote_now,
                             transmit_delta);
@@ -149,8 +655,8 @@ namespace qperf {
 
             if (arrival_delta <= 0) {
                 SPDLOG_INFO("-- negative/zero arrival delta -- {} {} {} {} {}",
-                            object_header.group_id,
-                            object_header.object_id,
+                            record.group_id,
+                            record.object_id,
                             local_now_,
                             last_local_now_,
                             arrival_delta);
@@ -167,18 +673,75 @@ namespace qperf {
             SPDLOG_TRACE("OR, RUNNING, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
                          test_identifier_,
                          perf_config_.test_name,
-                         object_header.group_id,
-                         object_header.object_id,
-                         data_span.size(),
+                         record.group_id,
+                         record.object_id,
+                         record.size,
                          local_now_,
                          remote_now,
                          transmit_delta,
                          arrival_delta,
-                         total_objects_,
+                         total_objects_.load(),
                          total_bytes_);
 
+            const auto resubscribe_time = resubscribe_time_.load(std::memory_order_acquire);
+            if (resubscribe_time != 0 && record.received_time >= resubscribe_time && !first_pass_) {
+                TrackRestore(record, resubscribe_time);
+            }
+
+            const auto lost_objects = lost_objects_;
+            TrackLoss(record);
+            TrackStale(record, lost_objects_ > lost_objects ? lost_objects_ - lost_objects : 0);
+            if (!layer_schedule_.Empty()) {
+                TrackLayer(record);
+            }
+            TrackGroup(record);
+            TrackPosition(record);
+            if (sync_skew_) {
+                sync_skew_->Record(
+                  sync_track_, record.test.time, static_cast<std::int64_t>(record.received_time - record.test.time));
+            }
+            TrackJoin(record);
+            publisher_relay_index_ = record.test.relay_index;
+            priority_inversions_ += record.priority_inverted;
+
+            if (record.integrity != IntegrityResult::kUnchecked) {
+                integrity_checked_ += 1;
+                if (record.integrity == IntegrityResult::kCorrupt) {
+                    integrity_corrupt_ += 1;
+                    SPDLOG_WARN("OR, {}, {} - corrupt object {}/{}",
+                                test_identifier_,
+                                perf_config_.test_name,
+                                record.group_id,
+                                record.object_id);
+                } else if (record.integrity == IntegrityResult::kSizeMismatch) {
+                    integrity_size_mismatch_ += 1;
+                    SPDLOG_WARN("OR, {}, {} - size mismatch object {}/{} size {}",
+                                test_identifier_,
+                                perf_config_.test_name,
+                                record.group_id,
+                                record.object_id,
+                                record.size);
+                }
+            }
+
+            if (!trace_path_.empty()) {
+                if (!trace_writer_.IsOpen() &&
+                    !trace_writer_.Open(trace_path_,
+                                        fmt::format("{}:{}", test_identifier_, perf_config_.test_name),
+                                        local_now_)) {
+                    trace_path_.clear();
+                }
+
+                trace_writer_.Write(TraceRecord{ local_now_ - trace_writer_.EpochBase(),
+                                                 record.group_id,
+                                                 record.object_id,
+                                                 static_cast<std::uint32_t>(record.size),
+                                                 0 });
+            }
+
             if (!first_pass_) {
 
+                transmit_latency_.RecordSigned(transmit_delta);
                 total_time_delta_ += transmit_delta;
                 max_object_time_delta_ = transmit_delta > (std::int64_t)max_object_time_delta_
                                            ? transmit_delta
@@ -196,12 +759,10 @@ namespace qperf {
                                               : (std::int64_t)min_object_arrival_delta_;
             }
 
-        } else if (test_mode_ == qperf::TestMode::kComplete) {
-
-            ObjectTestComplete test_complete;
+        } else if (test_mode == qperf::TestMode::kComplete) {
 
-            memset(&test_complete, '\0', sizeof(test_complete));
-            memcpy(&test_complete, data_span.data(), sizeof(test_complete));
+            const auto& test_complete = record.test;
+            std::lock_guard<std::mutex> metrics_lock(metrics_mutex_);
 
             std::int64_t total_time = local_now_ - start_data_time_;
             avg_object_time_delta_ = (double)total_time_delta_ / (double)total_objects_;
@@ -213,7 +774,7 @@ namespace qperf {
             SPDLOG_INFO("Testing Complete");
             SPDLOG_INFO("       Total test run time (ms) {}", total_time / 1000.0f);
             SPDLOG_INFO("      Configured test time (ms) {}", perf_config_.total_transmit_time);
-            SPDLOG_INFO("       Total subscribed objects {}, bytes {}", total_objects_, total_bytes_);
+            SPDLOG_INFO("       Total subscribed objects {}, bytes {}", total_objects_.load(), total_bytes_);
             SPDLOG_INFO("        Total published objects {}, bytes {}",
                         test_complete.test_metrics.total_published_objects,
                         test_complete.test_metrics.total_published_bytes);
@@ -235,17 +796,18 @@ namespace qperf {
             SPDLOG_INFO("                            avg {:04.3f}", avg_object_arrival_delta_);
             SPDLOG_INFO("                            over_multiplier {}",
                         static_cast<int>(avg_object_arrival_delta_ / (perf_config_.transmit_interval * 10000)));
+            SPDLOG_INFO("                    Clock steps {}", TimeSource::Instance().ClockSteps());
             SPDLOG_INFO("--------------------------------------------");
 
             // id,test_name,total_time,total_transmit_time,total_objects,total_bytes,sent_object,sent_bytes,min_bitrate,
             //       max_bitrate,avg_bitrate,min_time,maxtime,avg_time,min_arrival,max_arrival,avg_arrival,
-            //       delta_objects,arrival_over_multiplier
-            SPDLOG_INFO("OR COMPLETE, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+            //       delta_objects,arrival_over_multiplier,clock_steps
+            SPDLOG_INFO("OR COMPLETE, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
                         test_identifier_,
                         perf_config_.test_name,
                         total_time,
                         perf_config_.total_transmit_time,
-                        total_objects_,
+                        total_objects_.load(),
                         total_bytes_,
                         test_complete.test_metrics.total_published_objects,
                         test_complete.test_metrics.total_published_bytes,
@@ -259,12 +821,150 @@ namespace qperf {
                         max_object_arrival_delta_,
                         avg_object_arrival_delta_,
                         test_complete.test_metrics.total_published_objects - total_objects_,
-                        static_cast<int>(avg_object_arrival_delta_ / (perf_config_.transmit_interval * 10000)));
+                        static_cast<int>(avg_object_arrival_delta_ / (perf_config_.transmit_interval * 10000)),
+                        TimeSource::Instance().ClockSteps());
+
+            // id,test_name,p50,p90,p99,p99.9,max transmit latency (us)
+            SPDLOG_INFO("OR LATENCY, {}, {}, {}, {}, {}, {}, {}",
+                        test_identifier_,
+                        perf_config_.test_name,
+                        transmit_latency_.Percentile(50),
+                        transmit_latency_.Percentile(90),
+                        transmit_latency_.Percentile(99),
+                        transmit_latency_.Percentile(99.9),
+                        transmit_latency_.Max());
+
+            // id,test_name,lost_objects,reordered_objects,dropped_records
+            SPDLOG_INFO("OR LOSS, {}, {}, {}, {}, {}",
+                        test_identifier_,
+                        perf_config_.test_name,
+                        lost_objects_,
+                        reordered_objects_,
+                        records_dropped_.load());
+
+            if (perf_config_.ttl > 0) {
+                const auto ttl_lost_objects = std::min(ttl_lost_objects_, lost_objects_);
+
+                // id,test_name,ttl_ms,stale_objects,stale_bytes,age 0-25,25-50,50-75,75-100,100+ % of ttl,
+                //       ttl_lost_objects,transport_lost_objects
+                SPDLOG_INFO("OR TTL, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+                            test_identifier_,
+                            perf_config_.test_name,
+                            perf_config_.ttl,
+                            stale_objects_,
+                            stale_bytes_,
+                            age_buckets_[0],
+                            age_buckets_[1],
+                            age_buckets_[2],
+                            age_buckets_[3],
+                            age_buckets_[4],
+                            ttl_lost_objects,
+                            lost_objects_ - ttl_lost_objects);
+            }
+
+            // id,test_name,priority,objects,lost_objects,inversions,p50,p99,max transmit latency (us)
+            SPDLOG_INFO("OR PRIORITY, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+                        test_identifier_,
+                        perf_config_.test_name,
+                        perf_config_.priority,
+                        total_objects_.load(),
+                        lost_objects_,
+                        priority_inversions_,
+                        transmit_latency_.Percentile(50),
+                        transmit_latency_.Percentile(99),
+                        transmit_latency_.Max());
+
+            ReportLayers();
+            ReportPositions();
+
+            // The newest group is cut short by the end of the test, the others in flight are incomplete
+            const auto newest_group = std::max_element(
+              groups_.begin(), groups_.end(), [](const auto& a, const auto& b) { return a.group_id < b.group_id; });
+            for (auto& group : groups_) {
+                if (&group != &*newest_group) {
+                    FinishGroup(group);
+                    group.complete = true;
+                }
+            }
+
+            // id,test_name,complete_groups,incomplete_groups,p50,p90,p99,max group completion latency (us)
+            SPDLOG_INFO("OR GROUP, {}, {}, {}, {}, {}, {}, {}, {}",
+                        test_identifier_,
+                        perf_config_.test_name,
+                        group_latency_.Count(),
+                        incomplete_groups_,
+                        group_latency_.Percentile(50),
+                        group_latency_.Percentile(90),
+                        group_latency_.Percentile(99),
+                        group_latency_.Max());
+
+            const std::uint64_t join_time = join_time_;
+            if (join_time != 0) {
+                const auto since_join = [join_time](std::uint64_t time) -> std::int64_t {
+                    return time ? static_cast<std::int64_t>(time - join_time) : -1;
+                };
+                const auto catchup_time = catchup_last_time_ - catchup_first_time_;
+                const auto catchup_bitrate = catchup_time ? catchup_bytes_ * 8 * 1'000'000 / catchup_time : 0;
+
+                // id,test_name,filter_type,join_delay,first_object_us,first_group_start_us,catchup_objects,
+                //       catchup_bytes,catchup_bitrate
+                SPDLOG_INFO("OR JOIN, {}, {}, {}, {}, {}, {}, {}, {}, {}",
+                            test_identifier_,
+                            perf_config_.test_name,
+                            FilterTypeName(perf_config_.filter_type),
+                            perf_config_.join_delay,
+                            since_join(first_object_time_),
+                            since_join(first_group_start_time_),
+                            catchup_objects_,
+                            catchup_bytes_,
+                            catchup_bitrate);
+            }
+
+            // id,test_name,publisher_relay,subscriber_relay,objects,lost_objects,p50,p99 transmit latency (us)
+            SPDLOG_INFO("OR RELAY, {}, {}, {}, {}, {}, {}, {}, {}",
+                        test_identifier_,
+                        perf_config_.test_name,
+                        publisher_relay_index_,
+                        perf_config_.relay_index,
+                        total_objects_.load(),
+                        lost_objects_,
+                        transmit_latency_.Percentile(50),
+                        transmit_latency_.Percentile(99));
+
+            if (outages_ > 0) {
+                // id,test_name,outages,lost_objects,max_restore_us
+                SPDLOG_INFO("OR OUTAGE, {}, {}, {}, {}, {}",
+                            test_identifier_,
+                            perf_config_.test_name,
+                            outages_,
+                            outage_lost_objects_,
+                            max_restore_time_);
+            }
+
+            if (perf_config_.integrity != IntegrityMode::kNone) {
+                // id,test_name,checked,corrupt,size_mismatch
+                SPDLOG_INFO("OR INTEGRITY, {}, {}, {}, {}, {}",
+                            test_identifier_,
+                            perf_config_.test_name,
+                            integrity_checked_,
+                            integrity_corrupt_,
+                            integrity_size_mismatch_);
+            }
+
+            if (trace_writer_.IsOpen()) {
+                trace_writer_.Close();
+                // id,test_name,trace_path,records
+                SPDLOG_INFO("OR TRACE, {}, {}, {}, {}",
+                            test_identifier_,
+                            perf_config_.test_name,
+                            trace_path_,
+                            trace_writer_.Count());
+            }
             terminate_ = true;
             return;
         } else {
             SPDLOG_WARN(
-              "OR, {}, {} - unknown data identifier {}", test_identifier_, perf_config_.test_name, (int)test_mode_);
+              "OR, {}, {} - unknown data identifier {}", test_identifier_, perf_config_.test_name, (int)test_mode);
         }
 
         last_local_now_ = local_now_;
@@ -274,17 +974,19 @@ namespace qperf {
     void PerfSubscribeTrackHandler::MetricsSampled(const quicr::SubscribeTrackMetrics& metrics)
     {
         metrics_ = metrics;
+        TimeSource::Instance().CheckClockStep();
+
+        auto now = std::chrono::steady_clock::now();
         if (last_bytes_ == 0) {
-            last_metric_time_ =
-              std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
+            last_metric_time_ = now;
             last_bytes_ = metrics.bytes_received;
             return;
         }
 
-        auto now = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
         auto diff = std::chrono::duration_cast<std::chrono::seconds>(now - last_metric_time_);
 
         if (test_mode_ == qperf::TestMode::kRunning) {
+            std::lock_guard<std::mutex> metrics_lock(metrics_mutex_);
             std::uint64_t delta_bytes = metrics_.bytes_received - last_bytes_;
             std::uint64_t bitrate = ((delta_bytes) * 8) / std::max(diff.count(), std::int64_t(1));
             metric_samples_ += 1;
@@ -309,7 +1011,7 @@ namespace qperf {
                         avg_bitrate_);
         }
 
-        last_metric_time_ = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
+        last_metric_time_ = now;
         last_bytes_ = metrics.bytes_received;
     }
 }
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "sync_skew.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace qperf {
+    SyncSkewTracker::SyncSkewTracker(std::uint32_t participant_id)
+      : participant_id_(participant_id)
+    {
+    }
+
+    std::size_t SyncSkewTracker::AddTrack(const std::string& track_name)
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+        tracks_.emplace_back().name = track_name;
+        return tracks_.size() - 1;
+    }
+
+    void SyncSkewTracker::Record(std::size_t track, std::uint64_t publish_time, std::int64_t latency)
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+
+        newest_publish_time_ = std::max(newest_publish_time_, publish_time);
+        tracks_[track].recent.push_back(SkewEntry{ publish_time, latency });
+
+        if (track != 0) {
+            PairWaiting(tracks_[track], false);
+            return;
+        }
+
+        newest_reference_time_ = std::max(newest_reference_time_, publish_time);
+
+        // Reference objects arrive mostly in publish order, a late straggler expires with its successor
+        auto& reference = tracks_.front().recent;
+        while (!reference.empty() && reference.front().publish_time + kSkewWindowUs < newest_publish_time_) {
+            reference.pop_front();
+        }
+
+        for (std::size_t i = 1; i < tracks_.size(); ++i) {
+            PairWaiting(tracks_[i], false);
+        }
+    }
+
+    void SyncSkewTracker::PairWaiting(TrackSkew& track, bool flush)
+    {
+        while (!track.recent.empty()) {
+            const auto entry = track.recent.front();
+
+            // The closest reference object may still be in flight until the reference delivered past this one
+            if (!flush && newest_reference_time_ < entry.publish_time &&
+                entry.publish_time + kSkewWindowUs >= newest_publish_time_) {
+                return;
+            }
+
+            track.recent.pop_front();
+            Pair(track, entry);
+        }
+    }
+
+    void SyncSkewTracker::Pair(TrackSkew& track, const SkewEntry& entry)
+    {
+        const SkewEntry* closest = nullptr;
+        std::uint64_t closest_apart = kSameTimeUs;
+        for (const auto& reference : tracks_.front().recent) {
+            const auto apart = reference.publish_time > entry.publish_time
+                                 ? reference.publish_time - entry.publish_time
+                                 : entry.publish_time - reference.publish_time;
+            if (apart <= closest_apart) {
+                closest = &reference;
+                closest_apart = apart;
+            }
+        }
+
+        if (closest == nullptr) {
+            return;
+        }
+
+        const auto skew = entry.latency - closest->latency;
+        if (skew >= 0) {
+            track.later.Record(static_cast<std::uint64_t>(skew));
+        } else {
+            track.earlier.Record(static_cast<std::uint64_t>(-skew));
+        }
+        track.total_skew += skew;
+    }
+
+    void SyncSkewTracker::Report(const std::string& endpoint_id)
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+
+        for (std::size_t i = 1; i < tracks_.size(); ++i) {
+            auto& track = tracks_[i];
+            PairWaiting(track, true);
+
+            Histogram skew;
+            skew.Merge(track.later);
+            skew.Merge(track.earlier);
+
+            // endpoint,participant,reference_track,track,pairs,track_later,track_earlier,mean_skew,
+            //       p50,p99,max absolute skew (us)
+            SPDLOG_INFO("OR SYNC, {}, {}, {}, {}, {}, {}, {}, {:.0f}, {}, {}, {}",
+                        endpoint_id,
+                        participant_id_,
+                        tracks_.front().name,
+                        track.name,
+                        skew.Count(),
+                        track.later.Count(),
+                        track.earlier.Count(),
+                        skew.Count() ? double(track.total_skew) / skew.Count() : 0.0,
+                        skew.Percentile(50),
+                        skew.Percentile(99),
+                        skew.Max());
+        }
+    }
+} // namespace qperf
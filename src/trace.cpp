@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: Copyright (c) 2025 Cisco Systems
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "trace.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace qperf {
+    namespace {
+        // Consumed pages are released in chunks to keep the madvise calls rare
+        constexpr std::size_t kReleaseChunk = 8 * 1024 * 1024;
+        constexpr std::size_t kWriteBufferSize = 1024 * 1024;
+    }
+
+    TraceReader::~TraceReader()
+    {
+        if (data_ != nullptr) {
+            munmap(const_cast<std::uint8_t*>(data_), size_);
+        }
+    }
+
+    bool TraceReader::Open(const std::string& path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            SPDLOG_ERROR("Failed to open trace {}: {}", path, std::strerror(errno));
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(TraceFileHeader)) {
+            SPDLOG_ERROR("Trace {} is too short", path);
+            close(fd);
+            return false;
+        }
+
+        size_ = st.st_size;
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (mapping == MAP_FAILED) {
+            SPDLOG_ERROR("Failed to map trace {}: {}", path, std::strerror(errno));
+            size_ = 0;
+            return false;
+        }
+
+        data_ = static_cast<const std::uint8_t*>(mapping);
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+
+        std::memcpy(&header_, data_, sizeof(header_));
+        if (std::memcmp(header_.magic, kTraceMagic, sizeof(kTraceMagic)) != 0 || header_.version != kTraceVersion ||
+            header_.header_size < sizeof(TraceFileHeader) || header_.header_size > size_) {
+            SPDLOG_ERROR("{} is not a version {} qperf trace", path, kTraceVersion);
+            return false;
+        }
+
+        count_ = (size_ - header_.header_size) / sizeof(TraceRecord);
+        next_ = 0;
+        return true;
+    }
+
+    bool TraceReader::Next(TraceRecord& record)
+    {
+        if (next_ >= count_) {
+            return false;
+        }
+
+        std::memcpy(&record, data_ + header_.header_size + next_ * sizeof(TraceRecord), sizeof(record));
+        next_ += 1;
+
+        ReleaseConsumed();
+        return true;
+    }
+
+    void TraceReader::ReleaseConsumed()
+    {
+        const auto consumed = header_.header_size + next_ * sizeof(TraceRecord);
+        if (consumed - released_ < kReleaseChunk) {
+            return;
+        }
+
+        // madvise needs page aligned ranges
+        const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        const auto release_to = consumed / page_size * page_size;
+        if (release_to > released_) {
+            madvise(const_cast<std::uint8_t*>(data_) + released_, release_to - released_, MADV_DONTNEED);
+            released_ = release_to;
+        }
+    }
+
+    TraceWriter::~TraceWriter()
+    {
+        Close();
+    }
+
+    bool TraceWriter::Open(const std::string& path, const std::string& track_name, std::uint64_t epoch_base_us)
+    {
+        Close();
+
+        file_ = std::fopen(path.c_str(), "wb");
+        if (file_ == nullptr) {
+            SPDLOG_ERROR("Failed to create trace {}: {}", path, std::strerror(errno));
+            return false;
+        }
+        std::setvbuf(file_, nullptr, _IOFBF, kWriteBufferSize);
+
+        TraceFileHeader header;
+        std::memset(&header, '\0', sizeof(header));
+        std::memcpy(header.magic, kTraceMagic, sizeof(kTraceMagic));
+        header.version = kTraceVersion;
+        header.header_size = sizeof(header);
+        header.epoch_base_us = epoch_base_us;
+        std::memcpy(header.track_name, track_name.data(), std::min(track_name.size(), sizeof(header.track_name) - 1));
+
+        std::fwrite(&header, sizeof(header), 1, file_);
+
+        epoch_base_us_ = epoch_base_us;
+        count_ = 0;
+        return true;
+    }
+
+    void TraceWriter::Write(const TraceRecord& record)
+    {
+        if (file_ == nullptr) {
+            return;
+        }
+
+        std::fwrite(&record, sizeof(record), 1, file_);
+        count_ += 1;
+    }
+
+    void TraceWriter::Close()
+    {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+} // namespace qperf